@@ -0,0 +1,984 @@
+#include "harmony.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <numeric>
+#include <atomic>
+#include <cmath>
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <memory>
+#include <cstdint>
+#include <future>
+#include <thread>
+#include <string>
+#include <string_view>
+
+#include "expected.hpp"
+
+namespace bench {
+
+  /**
+  * @brief 値が最適化によって消去されないようにする
+  */
+  template<typename T>
+  inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+  }
+
+  /**
+  * @brief fをiterations回実行し、1回あたりの平均実行時間[ns]を返す
+  * @details 計測前に1度だけウォームアップとして実行する
+  */
+  template<typename F>
+  double measure_ns(std::size_t iterations, F&& f) {
+    f();
+
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i) {
+      f();
+    }
+    const auto end = std::chrono::steady_clock::now();
+
+    return std::chrono::duration<double, std::nano>(end - start).count() / double(iterations);
+  }
+
+  /**
+  * @brief 1つの計測結果
+  * @details 同じgroupの最初の結果を基準として比率を表示する
+  */
+  struct result {
+    std::string group;
+    std::string name;
+    double ns_per_op;
+  };
+
+  inline std::vector<result> results;
+
+  void record(std::string group, std::string name, double ns_per_op) {
+    results.push_back({ std::move(group), std::move(name), ns_per_op });
+  }
+
+  /**
+  * @brief sachetと同じ型を保持するstd::variantとのレイアウトの比較
+  */
+  struct layout {
+    std::string name;
+    std::size_t sachet_size;
+    std::size_t variant_size;
+    bool sachet_trivial;
+    bool variant_trivial;
+  };
+
+  inline std::vector<layout> layouts;
+
+  /**
+  * @brief 計測結果をgroupごとに表形式で出力する
+  */
+  void print_table() {
+    std::string_view current{};
+    double baseline = 0.0;
+
+    for (const auto& r : results) {
+      if (r.group != current) {
+        current = r.group;
+        baseline = r.ns_per_op;
+        std::printf("# %s\n", r.group.c_str());
+      }
+      std::printf("  %-24s %14.3f ns/op %8.2fx\n", r.name.c_str(), r.ns_per_op, baseline / r.ns_per_op);
+    }
+
+    std::printf("# layout\n  %-36s %12s %12s %16s %16s\n", "type", "sizeof", "variant", "trivial copy", "variant trivial");
+    for (const auto& l : layouts) {
+      std::printf("  %-36s %12zu %12zu %16s %16s\n", l.name.c_str(), l.sachet_size, l.variant_size, l.sachet_trivial ? "yes" : "no", l.variant_trivial ? "yes" : "no");
+    }
+  }
+
+  /**
+  * @brief 計測結果をJSONで出力する
+  */
+  void print_json() {
+    std::printf("{\n  \"workers\": %zu,\n  \"benchmarks\": [\n", harmony::detail::hardware_workers());
+
+    for (std::size_t i = 0; i < results.size(); ++i) {
+      const auto& r = results[i];
+      std::printf("    {\"group\": \"%s\", \"name\": \"%s\", \"ns_per_op\": %.3f}%s\n", r.group.c_str(), r.name.c_str(), r.ns_per_op, i + 1 == results.size() ? "" : ",");
+    }
+
+    std::printf("  ],\n  \"layouts\": [\n");
+
+    for (std::size_t i = 0; i < layouts.size(); ++i) {
+      const auto& l = layouts[i];
+      std::printf("    {\"type\": \"%s\", \"sizeof\": %zu, \"variant_sizeof\": %zu, \"trivially_copyable\": %s, \"variant_trivially_copyable\": %s}%s\n",
+        l.name.c_str(), l.sachet_size, l.variant_size, l.sachet_trivial ? "true" : "false", l.variant_trivial ? "true" : "false", i + 1 == layouts.size() ? "" : ",");
+    }
+
+    std::printf("  ]\n}\n");
+  }
+
+  /**
+  * @brief 逐次bindとpar_thenの要素数ごとの実行時間を比較し、並列化が有利になる要素数を探る
+  */
+  void par_then_crossover() {
+    using namespace harmony::monadic_op;
+
+    auto f = [](double x) { return std::sqrt(x * x + 1.0) * 0.5; };
+
+    for (std::size_t size = std::size_t(1) << 10; size <= (std::size_t(1) << 22); size <<= 2) {
+      std::vector<double> vec(size);
+      std::iota(vec.begin(), vec.end(), 0.0);
+
+      const std::size_t iterations = std::max<std::size_t>(1, (std::size_t(1) << 24) / size);
+      const std::string group = "par_then/size=" + std::to_string(size);
+
+      record(group, "serial", measure_ns(iterations, [&] {
+        harmony::monas(vec) | f;
+        do_not_optimize(vec.data());
+      }) / double(size));
+
+      // 並列化の閾値を無視してどの要素数でもスレッドを起こした時のコストを見る
+      record(group, "par_then", measure_ns(iterations, [&] {
+        vec | par_then(f, size / harmony::detail::hardware_workers() + 1);
+        do_not_optimize(vec.data());
+      }) / double(size));
+    }
+  }
+
+  /**
+  * @brief 算術型の連続範囲に対するbindについて、イテレータとCPOを介したループ・ポインタループ・simd_thenを比較する
+  */
+  void list_bind_vectorization() {
+    using namespace harmony::monadic_op;
+
+    auto f = [](auto x) { return x * 1.5f + 2.0f; };
+
+    for (std::size_t size = std::size_t(1) << 10; size <= (std::size_t(1) << 20); size <<= 2) {
+      std::vector<float> vec(size, 1.0f);
+
+      const std::size_t iterations = std::max<std::size_t>(1, (std::size_t(1) << 26) / size);
+      const std::string group = "list_bind/float/size=" + std::to_string(size);
+
+      // 以前のlistのbindの実装と同等のループ
+      record(group, "cpo_loop", measure_ns(iterations, [&] {
+        auto r = harmony::cpo::unwrap(vec);
+        auto it = std::ranges::begin(r);
+        const auto fin = std::ranges::end(r);
+        for (; it != fin; ++it) {
+          harmony::cpo::unit(it, f(*it));
+        }
+        do_not_optimize(vec.data());
+      }) / double(size));
+
+      record(group, "bind", measure_ns(iterations, [&] {
+        harmony::monas(vec) | [&](float x) { return f(x); };
+        do_not_optimize(vec.data());
+      }) / double(size));
+
+      record(group, "simd_then", measure_ns(iterations, [&] {
+        vec | simd_then(f);
+        do_not_optimize(vec.data());
+      }) / double(size));
+    }
+  }
+
+  struct payload {
+    std::array<double, 32> data;
+  };
+
+  /**
+  * @brief 10段のbindチェーンについて、通常のbindとfusedを比較する
+  */
+  void fused_chain() {
+    using namespace harmony::monadic_op;
+
+    auto step = [](const payload& p) {
+      payload r;
+      for (std::size_t i = 0; i < r.data.size(); ++i) {
+        r.data[i] = p.data[i] * 0.5 + 1.0;
+      }
+      return r;
+    };
+
+    std::optional<payload> opt = payload{};
+    std::optional<payload> none{};
+
+    constexpr std::size_t iterations = 1'000'000;
+
+    record("fused/10stage/valid", "chain", measure_ns(iterations, [&] {
+      harmony::monas(opt) | step | step | step | step | step | step | step | step | step | step;
+      do_not_optimize(&opt);
+    }));
+
+    record("fused/10stage/valid", "fused", measure_ns(iterations, [&] {
+      harmony::monas(opt) | fused(step, step, step, step, step, step, step, step, step, step);
+      do_not_optimize(&opt);
+    }));
+
+    record("fused/10stage/invalid", "chain", measure_ns(iterations, [&] {
+      harmony::monas(none) | step | step | step | step | step | step | step | step | step | step;
+      do_not_optimize(&none);
+    }));
+
+    record("fused/10stage/invalid", "fused", measure_ns(iterations, [&] {
+      harmony::monas(none) | fused(step, step, step, step, step, step, step, step, step, step);
+      do_not_optimize(&none);
+    }));
+  }
+
+  /**
+  * @brief sachet<L, R>とstd::variant<L, R>について、サイズとコピー・値の取り出しのコストを比較する
+  */
+  template<typename L, typename R>
+  void sachet_storage(const char* name, R valid_value, L invalid_value) {
+    using sachet_t = harmony::sachet<L, R>;
+    using variant_t = std::variant<L, R>;
+
+    layouts.push_back({ name, sizeof(sachet_t), sizeof(variant_t), std::is_trivially_copyable_v<sachet_t>, std::is_trivially_copyable_v<variant_t> });
+
+    constexpr std::size_t size = 4096;
+    constexpr std::size_t iterations = 2000;
+
+    std::vector<sachet_t> sachets;
+    std::vector<variant_t> variants;
+    sachets.reserve(size);
+    variants.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      if ((i * 7919) % 100 < 90) {
+        sachets.emplace_back(std::in_place_index<1>, valid_value);
+        variants.emplace_back(std::in_place_index<1>, valid_value);
+      } else {
+        sachets.emplace_back(std::in_place_index<0>, invalid_value);
+        variants.emplace_back(std::in_place_index<0>, invalid_value);
+      }
+    }
+
+    auto sachet_dst = sachets;
+    auto variant_dst = variants;
+    const std::string copy_group = std::string("sachet/copy/") + name;
+
+    record(copy_group, "std::variant", measure_ns(iterations, [&] {
+      std::copy(variants.begin(), variants.end(), variant_dst.begin());
+      do_not_optimize(variant_dst.data());
+    }) / double(size));
+
+    record(copy_group, "sachet", measure_ns(iterations, [&] {
+      std::copy(sachets.begin(), sachets.end(), sachet_dst.begin());
+      do_not_optimize(sachet_dst.data());
+    }) / double(size));
+
+    const std::string access_group = std::string("sachet/access/") + name;
+
+    record(access_group, "std::variant", measure_ns(iterations, [&] {
+      std::size_t count = 0;
+      for (auto& v : variants) {
+        if (v.index() == 1) {
+          do_not_optimize(std::get<1>(v));
+          ++count;
+        }
+      }
+      do_not_optimize(count);
+    }) / double(size));
+
+    record(access_group, "sachet", measure_ns(iterations, [&] {
+      std::size_t count = 0;
+      for (auto& s : sachets) {
+        if (s) {
+          do_not_optimize(*s);
+          ++count;
+        }
+      }
+      do_not_optimize(count);
+    }) / double(size));
+  }
+
+  void sachet_layout() {
+    sachet_storage<std::exception_ptr, int>("sachet<exception_ptr, int>", 1, std::make_exception_ptr(1));
+    sachet_storage<int, int>("sachet<int, int>", 1, -1);
+    sachet_storage<int, double>("sachet<int, double>", 1.0, -1);
+    sachet_storage<std::string, int>("sachet<string, int>", 1, "error");
+    sachet_storage<int, std::array<char, 3>>("sachet<int, array<char, 3>>", std::array<char, 3>{}, -1);
+  }
+
+  /**
+  * @brief 計測対象の型ごとの入力の作り方と、手書きの処理に必要な無効値の作り方
+  */
+  struct optional_traits {
+    static constexpr const char* name = "optional";
+    using type = std::optional<int>;
+
+    static auto make(bool valid, int v) -> type { return valid ? type(v) : type(); }
+    static auto fail(const type&) -> type { return std::nullopt; }
+    static auto other(const type&) -> int { return 0; }
+  };
+
+  struct expected_traits {
+    static constexpr const char* name = "tl::expected";
+    using type = tl::expected<int, int>;
+
+    static auto make(bool valid, int v) -> type { return valid ? type(v) : type(tl::unexpect, -v); }
+    static auto fail(const type& e) -> type { return type(tl::unexpect, e.error()); }
+    static auto other(const type& e) -> int { return e.error(); }
+  };
+
+  struct sachet_traits {
+    static constexpr const char* name = "sachet";
+    using type = harmony::sachet<int, int>;
+
+    static auto make(bool valid, int v) -> type {
+      return valid ? type(std::in_place_index<1>, v) : type(std::in_place_index<0>, -v);
+    }
+    static auto fail(type& s) -> type { return type(std::in_place_index<0>, s.unwrap_err()); }
+    static auto other(type& s) -> int { return s.unwrap_err(); }
+  };
+
+  struct pointer_traits {
+    static constexpr const char* name = "pointer";
+    using type = int*;
+
+    // 指す先の領域はプログラム終了まで保持する
+    static inline std::vector<int> storage = std::vector<int>(1 << 16);
+    static inline std::size_t next = 0;
+
+    static auto make(bool valid, int v) -> type {
+      if (not valid) return nullptr;
+      int* p = &storage[next++ % storage.size()];
+      *p = v;
+      return p;
+    }
+    static auto fail(const type&) -> type { return nullptr; }
+    static auto other(const type&) -> int { return 0; }
+  };
+
+  /**
+  * @brief monas/then/map/and_then/match/fold_to（map_to）と、同等の手書きのif文の実行時間を比較する
+  * @param valid_percent 入力のうち有効値を持つものの割合
+  */
+  template<typename Traits>
+  void overhead_suite(int valid_percent) {
+    using namespace harmony::monadic_op;
+    using T = typename Traits::type;
+
+    constexpr std::size_t size = 4096;
+    constexpr std::size_t iterations = 2000;
+
+    std::vector<T> inputs;
+    inputs.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      // 有効/無効の並びが分岐予測で当たりすぎないように散らす
+      const bool valid = int((i * 7919) % 100) < valid_percent;
+      inputs.push_back(Traits::make(valid, int(i % 1000)));
+    }
+
+    auto inc = [](int n) { return (n + 1) % 1000; };
+    auto to_double = [](int n) { return double(n) * 0.5; };
+    auto chain = [](int n) { return Traits::make(n % 16 != 0, n); };
+    auto measure = [&](const std::string& op, const char* name, auto&& body) {
+      record(std::string(Traits::name) + "/" + op + "/valid=" + std::to_string(valid_percent) + "%", name, measure_ns(iterations, [&] {
+        for (auto& x : inputs) {
+          body(x);
+        }
+      }) / double(size));
+    };
+
+    measure("bind", "hand", [&](T& x) { if (x) *x = inc(*x); });
+    measure("bind", "monas", [&](T& x) { harmony::monas(x) | inc; });
+    measure("bind", "then", [&](T& x) { x | then(inc); });
+
+    measure("map", "hand", [&](T& x) {
+      auto r = x ? std::optional<double>(to_double(*x)) : std::nullopt;
+      do_not_optimize(r);
+    });
+    measure("map", "harmony", [&](T& x) {
+      auto r = x | map(to_double);
+      do_not_optimize(r);
+    });
+
+    // 無効値から結果の型を構築できない場合、and_thenは使用できない
+    if constexpr (requires(T& x) { x | and_then(chain); }) {
+      measure("and_then", "hand", [&](T& x) {
+        auto r = x ? chain(*x) : Traits::fail(x);
+        do_not_optimize(r);
+      });
+      measure("and_then", "harmony", [&](T& x) {
+        auto r = x | and_then(chain);
+        do_not_optimize(r);
+      });
+    }
+
+    measure("match", "hand", [&](T& x) {
+      int r = x ? inc(*x) : -1;
+      do_not_optimize(r);
+    });
+    measure("match", "harmony", [&](T& x) {
+      int r = x | match(inc, [](auto&&) { return -1; });
+      do_not_optimize(r);
+    });
+
+    if constexpr (std::is_class_v<T> and not std::same_as<T, std::optional<int>>) {
+      measure("fold_to", "hand", [&](T& x) {
+        int r = x ? *x : Traits::other(x);
+        do_not_optimize(r);
+      });
+      measure("fold_to", "harmony", [&](T& x) {
+        int r = harmony::monas(x) | fold_to<int>;
+        do_not_optimize(r);
+      });
+    } else {
+      // 単なるmaybeに対してはmap_toが無効値の時にデフォルト値を返す
+      measure("map_to", "hand", [&](T& x) {
+        int r = x ? *x : 0;
+        do_not_optimize(r);
+      });
+      measure("map_to", "harmony", [&](T& x) {
+        int r = harmony::monas(x) | map_to<int>;
+        do_not_optimize(r);
+      });
+    }
+  }
+
+  /**
+  * @brief std::vectorに対するbindと手書きのループを比較する
+  */
+  void vector_overhead() {
+    using namespace harmony::monadic_op;
+
+    std::vector<int> vec(4096);
+    std::iota(vec.begin(), vec.end(), 0);
+
+    auto inc = [](int n) { return (n + 1) % 1000; };
+    constexpr std::size_t iterations = 20000;
+
+    record("vector/bind", "hand", measure_ns(iterations, [&] {
+      for (auto& n : vec) n = inc(n);
+      do_not_optimize(vec.data());
+    }) / double(vec.size()));
+
+    record("vector/bind", "monas", measure_ns(iterations, [&] {
+      harmony::monas(vec) | inc;
+      do_not_optimize(vec.data());
+    }) / double(vec.size()));
+
+    record("vector/bind", "then", measure_ns(iterations, [&] {
+      vec | then(inc);
+      do_not_optimize(vec.data());
+    }) / double(vec.size()));
+  }
+
+  /**
+  * @brief eitherの範囲を有効値と無効値に振り分ける処理について、filterを2回行う場合とpartition_resultsを比較する
+  */
+  void partition_columns() {
+    using namespace harmony::monadic_op;
+    using input_t = tl::expected<int, int>;
+
+    constexpr std::size_t size = std::size_t(1) << 20;
+    constexpr std::size_t iterations = 20;
+
+    std::vector<input_t> inputs;
+    inputs.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      const bool valid = (i * 7919) % 100 < 50;
+      inputs.push_back(valid ? input_t(int(i)) : input_t(tl::unexpect, -int(i)));
+    }
+
+    std::vector<int> values;
+    std::vector<int> errors;
+    values.reserve(size);
+    errors.reserve(size);
+
+    const std::string group = "partition/size=" + std::to_string(size);
+
+    record(group, "two filters", measure_ns(iterations, [&] {
+      values.clear();
+      errors.clear();
+      for (const auto& x : inputs | std::views::filter([](const input_t& x) { return x.has_value(); })) values.push_back(*x);
+      for (const auto& x : inputs | std::views::filter([](const input_t& x) { return not x.has_value(); })) errors.push_back(x.error());
+      do_not_optimize(values.data());
+      do_not_optimize(errors.data());
+    }) / double(size));
+
+    record(group, "partition_results", measure_ns(iterations, [&] {
+      values.clear();
+      errors.clear();
+      inputs | partition_results(values, errors);
+      do_not_optimize(values.data());
+      do_not_optimize(errors.data());
+    }) / double(size));
+
+    record(group, "par_partition_results", measure_ns(iterations, [&] {
+      values.clear();
+      errors.clear();
+      inputs | par_partition_results(values, errors, size / harmony::detail::hardware_workers() + 1);
+      do_not_optimize(values.data());
+      do_not_optimize(errors.data());
+    }) / double(size));
+  }
+
+  /**
+  * @brief 有効値にだけ関数を適用する処理について、std::vector<sachet>をループする場合とeither_vectorへのbindを比較する
+  */
+  void either_vector_bind() {
+    using harmony::sachet;
+
+    constexpr std::size_t size = std::size_t(1) << 20;
+    constexpr std::size_t iterations = 20;
+
+    auto f = [](int n) { return n * 3 + 1; };
+
+    for (int valid_percent : {50, 90}) {
+      std::vector<sachet<int, int>> aos;
+      harmony::either_vector<int, int> soa;
+      aos.reserve(size);
+      soa.reserve(size, valid_percent / 100.0);
+
+      for (std::size_t i = 0; i < size; ++i) {
+        const bool valid = int((i * 7919) % 100) < valid_percent;
+        if (valid) {
+          aos.emplace_back(std::in_place_index<1>, int(i));
+          soa.emplace_value(int(i));
+        } else {
+          aos.emplace_back(std::in_place_index<0>, -int(i));
+          soa.emplace_error(-int(i));
+        }
+      }
+
+      const std::string group = "either_vector/bind/valid=" + std::to_string(valid_percent) + "%";
+
+      record(group, "vector<sachet>", measure_ns(iterations, [&] {
+        for (auto& x : aos) {
+          if (x) *x = f(*x);
+        }
+        do_not_optimize(aos.data());
+      }) / double(size));
+
+      record(group, "either_vector", measure_ns(iterations, [&] {
+        harmony::monas(soa) | f;
+        do_not_optimize(soa.values().data());
+      }) / double(size));
+    }
+  }
+
+  /**
+  * @brief nullを含みうる列へのbindについて、std::vector<std::optional<double>>とnullable_columnを比較する
+  * @details nullが散らばっている場合と、固まっている場合（全て有効なワードが多い）を見る
+  */
+  void nullable_column_bind() {
+    constexpr std::size_t size = std::size_t(1) << 20;
+    constexpr std::size_t iterations = 20;
+
+    auto f = [](double d) { return d * 0.5 + 1.0; };
+
+    for (auto [name, is_valid] : { std::pair<const char*, bool(*)(std::size_t)>
+          { "scattered 10% null", [](std::size_t i) { return (i * 7919) % 100 >= 10; } },
+          { "clustered 10% null", [](std::size_t i) { return (i / 4096) % 10 != 0; } } })
+    {
+      std::vector<std::optional<double>> aos;
+      harmony::nullable_column<double> column;
+      aos.reserve(size);
+      column.reserve(size);
+
+      for (std::size_t i = 0; i < size; ++i) {
+        if (is_valid(i)) {
+          aos.emplace_back(double(i));
+          column.push_back(double(i));
+        } else {
+          aos.emplace_back();
+          column.push_null();
+        }
+      }
+
+      const std::string group = std::string("nullable_column/bind/") + name;
+
+      record(group, "vector<optional>", measure_ns(iterations, [&] {
+        for (auto& x : aos) {
+          if (x) *x = f(*x);
+        }
+        do_not_optimize(aos.data());
+      }) / double(size));
+
+      record(group, "nullable_column", measure_ns(iterations, [&] {
+        harmony::monas(column) | f;
+        do_not_optimize(column.values().data());
+      }) / double(size));
+    }
+  }
+
+  template<typename E>
+  void validity_query_suite(const char* name, const std::vector<E>& inputs) {
+    using namespace harmony::monadic_op;
+
+    constexpr std::size_t iterations = 5;
+    const auto size = double(inputs.size());
+    auto is_valid = [](const E& e) { return harmony::detail::element_valid(e); };
+
+    const std::string count_group = std::string("validity/count_valid/") + name;
+
+    record(count_group, "count_if", measure_ns(iterations, [&] {
+      auto r = std::ranges::count_if(inputs, is_valid);
+      do_not_optimize(r);
+    }) / size);
+
+    record(count_group, "count_valid", measure_ns(iterations, [&] {
+      auto r = inputs | count_valid;
+      do_not_optimize(r);
+    }) / size);
+
+    // 全て有効な入力に対しては、最後まで走査する
+    const std::string all_group = std::string("validity/all_valid/") + name;
+
+    record(all_group, "all_of", measure_ns(iterations, [&] {
+      bool r = std::ranges::all_of(inputs, is_valid);
+      do_not_optimize(r);
+    }) / size);
+
+    record(all_group, "all_valid", measure_ns(iterations, [&] {
+      bool r = inputs | all_valid;
+      do_not_optimize(r);
+    }) / size);
+
+    const std::string first_group = std::string("validity/first_invalid/") + name;
+
+    record(first_group, "find_if_not", measure_ns(iterations, [&] {
+      auto r = std::ranges::find_if_not(inputs, is_valid);
+      do_not_optimize(r);
+    }) / size);
+
+    record(first_group, "first_invalid", measure_ns(iterations, [&] {
+      auto r = inputs | first_invalid;
+      do_not_optimize(r);
+    }) / size);
+  }
+
+  /**
+  * @brief maybeな値の範囲に対する有効性の問い合わせについて、標準アルゴリズムと比較する
+  * @details 要素数は10M、全て有効（first_invalidは末尾の1つだけ無効）
+  */
+  void validity_queries() {
+    constexpr std::size_t size = 10'000'000;
+
+    static int target = 0;
+
+    std::vector<std::optional<int>> optionals(size, 1);
+    optionals.back() = std::nullopt;
+    validity_query_suite("optional<int>", optionals);
+
+    std::vector<int*> pointers(size, &target);
+    pointers.back() = nullptr;
+    validity_query_suite("int*", pointers);
+
+    std::vector<double> doubles(size, 1.0);
+    doubles.back() = std::numeric_limits<double>::quiet_NaN();
+    validity_query_suite("double(NaN)", doubles);
+  }
+
+  /**
+  * @brief monasのチェーンと、同じチェーンをトレースした場合を比較する
+  * @details no_traceの場合はmonasと同じコードになることを確認する。funnelは常時有効にしておける程度のコストであることを確認する
+  */
+  void trace_overhead() {
+    using namespace harmony::monadic_op;
+
+    static_assert(sizeof(harmony::traced<std::optional<int>, harmony::no_trace>) == sizeof(harmony::monas<std::optional<int>>));
+
+    constexpr std::size_t size = 4096;
+    constexpr std::size_t iterations = 2000;
+
+    auto inc = [](int n) { return n + 1; };
+    auto half = [](int n) -> std::optional<int> { if (n % 2 == 0) return n / 2; return std::nullopt; };
+
+    for (int valid_percent : {100, 50}) {
+      std::vector<std::optional<int>> inputs;
+      inputs.reserve(size);
+      for (std::size_t i = 0; i < size; ++i) {
+        const bool valid = int((i * 7919) % 100) < valid_percent;
+        inputs.push_back(valid ? std::optional<int>(int(i) * 2 + 1) : std::nullopt);
+      }
+
+      const std::string group = "trace/4stage/valid=" + std::to_string(valid_percent) + "%";
+
+      record(group, "monas", measure_ns(iterations, [&] {
+        for (auto x : inputs) {
+          int r = harmony::monas(x) | inc | and_then(half) | inc | value_or(0);
+          do_not_optimize(r);
+        }
+      }) / double(size));
+
+      record(group, "trace(no_trace)", measure_ns(iterations, [&] {
+        for (auto x : inputs) {
+          int r = harmony::trace(x) | inc | and_then(half) | inc | value_or(0);
+          do_not_optimize(r);
+        }
+      }) / double(size));
+
+      harmony::trace_recorder rec;
+
+      record(group, "trace(recorder)", measure_ns(iterations, [&] {
+        for (auto x : inputs) {
+          rec.clear();
+          int r = harmony::trace(x, rec) | inc | and_then(half) | inc | value_or(0);
+          do_not_optimize(r);
+        }
+      }) / double(size));
+
+#ifdef __cpp_lib_source_location
+      record(group, "funnel", measure_ns(iterations, [&] {
+        for (auto x : inputs) {
+          int r = harmony::funnel(x) | inc | and_then(half) | inc | value_or(0);
+          do_not_optimize(r);
+        }
+      }) / double(size));
+#endif
+    }
+  }
+
+  /**
+  * @brief 同じチェーンを入力ごとに組み立てる場合と、合成済みのパイプラインを使い回す場合を比較する
+  * @details 状態を持つ関数（テーブルをshared_ptrで共有する）を入力ごとにコピーするとその分のコストがかかる
+  */
+  void pipeline_reuse() {
+    using namespace harmony::monadic_op;
+
+    constexpr std::size_t size = 4096;
+    constexpr std::size_t iterations = 2000;
+
+    std::vector<std::optional<int>> inputs;
+    inputs.reserve(size);
+    for (std::size_t i = 0; i < size; ++i) {
+      inputs.push_back(i % 8 == 0 ? std::nullopt : std::optional<int>(int(i)));
+    }
+
+    auto table = std::make_shared<std::vector<int>>(256);
+    std::iota(table->begin(), table->end(), 0);
+
+    auto lookup = [table](int n) { return (*table)[n & 255]; };
+    auto half = [](int n) -> std::optional<int> { if (n % 2 == 0) return n / 2; return std::nullopt; };
+    auto inc = [](int n) { return n + 1; };
+
+    const std::string group = "pipeline/4stage";
+
+    record(group, "inline chain", measure_ns(iterations, [&] {
+      for (auto x : inputs) {
+        int r = harmony::monas(x) | map(lookup) | and_then(half) | inc | value_or(0);
+        do_not_optimize(r);
+      }
+    }) / double(size));
+
+    record(group, "inline chain(copy)", measure_ns(iterations, [&] {
+      for (auto x : inputs) {
+        int r = harmony::monas(x) | map(decltype(lookup)(lookup)) | and_then(half) | inc | value_or(0);
+        do_not_optimize(r);
+      }
+    }) / double(size));
+
+    const auto p = map(lookup) >> and_then(half) >> inc >> value_or(0);
+
+    record(group, "pipeline", measure_ns(iterations, [&] {
+      for (auto x : inputs) {
+        int r = x | p;
+        do_not_optimize(r);
+      }
+    }) / double(size));
+  }
+
+  /**
+  * @brief CPU負荷の高いステージをthen_onでthread_poolに投げた場合の、ワーカー数に対するスケーリングを見る
+  */
+  void thread_pool_scaling() {
+    using namespace harmony::monadic_op;
+
+    constexpr std::size_t tasks = 256;
+    constexpr std::size_t iterations = 20;
+
+    auto heavy = [](double x) {
+      for (int i = 0; i < 20000; ++i) {
+        x = std::sqrt(x + double(i));
+      }
+      return x;
+    };
+
+    const std::size_t hw = std::max<std::size_t>(std::thread::hardware_concurrency(), 1);
+    std::vector<std::size_t> counts;
+    for (std::size_t n = 1; n < hw; n *= 2) counts.push_back(n);
+    counts.push_back(hw);
+
+    const std::string group = "thread_pool/then_on/" + std::to_string(tasks) + "tasks";
+
+    record(group, "inline", measure_ns(iterations, [&] {
+      for (std::size_t i = 0; i < tasks; ++i) {
+        double r = harmony::monas(std::optional<double>(double(i))) | heavy | value_or(0.0);
+        do_not_optimize(r);
+      }
+    }) / double(tasks));
+
+    for (std::size_t n : counts) {
+      harmony::thread_pool pool{n};
+      std::vector<std::future<std::optional<double>>> futures;
+      futures.reserve(tasks);
+
+      record(group, "pool(" + std::to_string(n) + ")", measure_ns(iterations, [&] {
+        futures.clear();
+        for (std::size_t i = 0; i < tasks; ++i) {
+          futures.push_back(std::optional<double>(double(i)) | then_on(pool, heavy));
+        }
+        for (auto& f : futures) {
+          auto r = f.get();
+          do_not_optimize(r);
+        }
+      }) / double(tasks));
+    }
+  }
+
+  /**
+  * @brief 大きな範囲から1つの要素を探すexistsを、逐次と並列で比較する
+  * @details 並列版では見つけたワーカーが共有フラグを立てるので、一致が先頭寄りでも他のワーカーはすぐに打ち切られる
+  */
+  void par_exists_scan() {
+    using namespace harmony::monadic_op;
+
+    constexpr std::size_t size = std::size_t(1) << 24;
+    constexpr std::size_t iterations = 10;
+
+    std::vector<std::int32_t> records(size);
+    std::iota(records.begin(), records.end(), 0);
+
+    const std::pair<const char*, std::size_t> positions[] = {
+      {"start", size / 100},
+      {"middle", size / 2},
+      {"end", size - 1},
+    };
+
+    for (auto [where, pos] : positions) {
+      const std::int32_t bad = std::int32_t(pos);
+      auto is_bad = [bad](std::int32_t r) { return r == bad; };
+
+      const std::string group = "par_exists/16M/match=" + std::string(where);
+
+      record(group, "exists", measure_ns(iterations, [&] {
+        bool r = records | exists(is_bad);
+        do_not_optimize(r);
+      }) / double(size));
+
+      record(group, "par_exists", measure_ns(iterations, [&] {
+        bool r = records | par_exists(is_bad);
+        do_not_optimize(r);
+      }) / double(size));
+    }
+  }
+
+#ifdef __cpp_lib_coroutine
+
+  /**
+  * @brief 複数の失敗しうる処理をco_awaitで繋いだコルーチンと、同等の手書きの早期リターンを比較する
+  * @details HALOが効かない処理系ではフレームの確保が発生するため、その差を見る
+  */
+  void coroutine_early_return() {
+    using input_t = tl::expected<int, int>;
+    using result_t = harmony::sachet<int, int>;
+
+    constexpr std::size_t size = 4096;
+    constexpr std::size_t iterations = 2000;
+
+    auto parse = [](int n) -> input_t {
+      if (n % 16 == 0) return tl::unexpected<int>(n);
+      return n % 1000 + 1;
+    };
+    auto ok = [](int n) { return result_t(std::in_place_index<1>, n); };
+    auto fail = [](int e) { return result_t(std::in_place_index<0>, e); };
+
+    auto hand = [&](const input_t& x) -> result_t {
+      if (not x) return fail(x.error());
+      const int a = *x;
+      auto y = parse(a);
+      if (not y) return fail(y.error());
+      const int b = *y;
+      auto z = parse(a + b);
+      if (not z) return fail(z.error());
+      return ok(a + b + *z);
+    };
+
+    auto coro = [&](const input_t& x) -> result_t {
+      const int a = co_await x;
+      const int b = co_await parse(a);
+      const int c = co_await parse(a + b);
+      co_return a + b + c;
+    };
+
+    for (int valid_percent : {100, 50, 0}) {
+      std::vector<input_t> inputs;
+      inputs.reserve(size);
+      for (std::size_t i = 0; i < size; ++i) {
+        const bool valid = int((i * 7919) % 100) < valid_percent;
+        inputs.push_back(valid ? input_t(int(i % 1000) * 16 + 1) : input_t(tl::unexpect, int(i)));
+      }
+
+      const std::string group = "coroutine/3step/valid=" + std::to_string(valid_percent) + "%";
+
+      record(group, "hand", measure_ns(iterations, [&] {
+        for (const auto& x : inputs) {
+          auto r = hand(x);
+          do_not_optimize(r);
+        }
+      }) / double(size));
+
+      record(group, "co_await", measure_ns(iterations, [&] {
+        for (const auto& x : inputs) {
+          auto r = coro(x);
+          do_not_optimize(r);
+        }
+      }) / double(size));
+    }
+  }
+
+#endif // __cpp_lib_coroutine
+
+  void abstraction_overhead() {
+    for (int valid_percent : {100, 50, 0}) {
+      overhead_suite<optional_traits>(valid_percent);
+      overhead_suite<expected_traits>(valid_percent);
+      overhead_suite<sachet_traits>(valid_percent);
+      overhead_suite<pointer_traits>(valid_percent);
+    }
+    vector_overhead();
+  }
+}
+
+/**
+* @brief 引数に--jsonを指定するとJSON形式で出力する
+*/
+int main(int argc, char* argv[]) {
+  bool json = false;
+  for (int i = 1; i < argc; ++i) {
+    if (std::string_view(argv[i]) == "--json") json = true;
+  }
+
+  bench::abstraction_overhead();
+  bench::par_then_crossover();
+  bench::list_bind_vectorization();
+  bench::fused_chain();
+  bench::sachet_layout();
+  bench::partition_columns();
+  bench::either_vector_bind();
+  bench::nullable_column_bind();
+  bench::validity_queries();
+  bench::trace_overhead();
+  bench::pipeline_reuse();
+  bench::thread_pool_scaling();
+  bench::par_exists_scan();
+#ifdef __cpp_lib_coroutine
+  bench::coroutine_early_return();
+#endif
+
+  if (json) {
+    bench::print_json();
+  } else {
+    bench::print_table();
+  }
+}
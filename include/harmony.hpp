@@ -9,6 +9,42 @@
 #include <functional>
 #include <any>
 #include <cmath>
+#include <vector>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <tuple>
+#include <future>
+#include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <bit>
+#include <span>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <array>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#endif
+
+#if __has_include(<source_location>)
+#include <source_location>
+#endif
+
+#if __has_include(<coroutine>)
+#include <coroutine>
+#endif
+
+// 例外が無効な環境（-fno-exceptionsなど）では、例外を扱う処理を取り除く
+#if !defined(HARMONY_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(_CPPUNWIND)
+#define HARMONY_NO_EXCEPTIONS
+#endif
 
 #ifdef _MSC_VER
 #pragma warning( push )
@@ -130,6 +166,28 @@ namespace harmony::detail {
     {std::forward<T>(t).value()} -> not_void;
   };
 
+  /**
+  * @brief variant_likeな値からI番目の値を取り出す
+  * @details 例外が無効な場合、std::variantに対してはインデックスをチェックしないstd::get_if()を使用する
+  */
+  template<std::size_t I, typename V>
+  [[nodiscard]]
+  constexpr decltype(auto) variant_get(V&& v) noexcept {
+#ifdef HARMONY_NO_EXCEPTIONS
+    if constexpr (requires { std::get_if<I>(std::addressof(v)); }) {
+      if constexpr (std::is_lvalue_reference_v<V>) {
+        return *std::get_if<I>(std::addressof(v));
+      } else {
+        return std::move(*std::get_if<I>(std::addressof(v)));
+      }
+    } else
+#endif
+    {
+      using std::get;
+      return get<I>(std::forward<V>(v));
+    }
+  }
+
   /**
   * @brief unwrap CPOの実装
   * @details 事前条件 : 各処理は取り出す値が存在している事を仮定する（言い換えると、validate()でチェック済みであること）
@@ -169,11 +227,16 @@ namespace harmony::detail {
 
     /**
     * @brief range（listモナド）はref_viewで返す
+    * @details コピーできないview（owning_viewを含むものなど）もref_viewで参照する
     */
     template<std::ranges::range R>
     [[nodiscard]]
     constexpr auto operator()(R&& r) const noexcept {
-      return std::views::all(r);
+      if constexpr (std::ranges::viewable_range<R&>) {
+        return std::views::all(r);
+      } else {
+        return std::ranges::ref_view(r);
+      }
     }
 
     /**
@@ -182,8 +245,7 @@ namespace harmony::detail {
     template<variant_like V>
     [[nodiscard]]
     constexpr decltype(auto) operator()(V&& v) const noexcept {
-      using std::get;
-      return get<1>(std::forward<V>(v));
+      return variant_get<1>(std::forward<V>(v));
     }
 
     /**
@@ -198,11 +260,16 @@ namespace harmony::detail {
         , std::variant<std::exception_ptr, std::reference_wrapper<std::remove_reference_t<R>>>
         , std::variant<std::exception_ptr, R>>;
 
+#ifdef HARMONY_NO_EXCEPTIONS
+      // 例外が無効な場合、get()は失敗しない（失敗するような状態ならプログラムは終了する）
+      return result_t(std::in_place_index<1>, std::forward<F>(f).get());
+#else
       try {
         return result_t(std::in_place_index<1>, std::forward<F>(f).get());
       } catch(...) {
         return result_t(std::in_place_index<0>, std::current_exception());
       }
+#endif
     }
 
     template<not_void R, any_like A>
@@ -297,7 +364,8 @@ namespace harmony::detail {
     * @brief std::ranges::empty()CPOによって状態を取得
     */
     template<typename T>
-      requires requires(const T& t) { {std::ranges::empty(t)} -> std::same_as<bool>; }
+      requires not_boolean_convertible<T> and
+               requires(const T& t) { {std::ranges::empty(t)} -> std::same_as<bool>; }
     [[nodiscard]]
     constexpr bool operator()(const T& t) const noexcept(noexcept(std::ranges::empty(t))) {
       return not std::ranges::empty(t);
@@ -497,8 +565,7 @@ namespace harmony::detail {
     template<variant_like V>
     [[nodiscard]]
     constexpr decltype(auto) operator()(V&& v) const noexcept {
-      using std::get;
-      return get<0>(std::forward<V>(v));
+      return variant_get<0>(std::forward<V>(v));
     }
   };
 
@@ -567,7 +634,7 @@ namespace harmony {
 
   namespace detail {
     template<typename M, typename F, typename R = std::invoke_result_t<F, traits::unwrap_t<M&>>>
-    inline constexpr bool monadic_noexecpt_v = noexcept(cpo::unit(std::declval<M&>(), std::declval<R>()));
+    inline constexpr bool monadic_noexecpt_v = std::is_nothrow_invocable_v<F, traits::unwrap_t<M&>> and noexcept(cpo::unit(std::declval<M&>(), std::declval<R>()));
 
     template<typename F, typename T>
     concept map_reusable = requires(T&& t, F&& f) {
@@ -614,6 +681,81 @@ namespace harmony {
 
     template<typename F, typename T>
     concept not_or_else_reusable = not or_else_reusable<F, T>;
+
+    /**
+    * @brief 連続したメモリ上の算術型の要素に対して、fの結果を直接代入できる
+    */
+    template<typename I, typename F>
+    concept contiguous_arithmetic_bindable =
+      std::contiguous_iterator<I> and
+      std::is_arithmetic_v<std::iter_value_t<I>> and
+      std::invocable<F&, std::iter_value_t<I>&> and
+      std::assignable_from<std::iter_value_t<I>&, std::invoke_result_t<F&, std::iter_value_t<I>&>>;
+
+    /**
+    * @brief listの要素に対するbindの本体、[first, last)の各要素にfを適用して再代入する
+    * @details 算術型の連続範囲の場合はCPOとイテレータを介さずにポインタで直接ループし、自動ベクトル化されやすくする
+    */
+    template<typename I, typename S, typename F>
+    constexpr void bind_elements(I first, S last, F& f) {
+      if constexpr (contiguous_arithmetic_bindable<I, F> and std::sized_sentinel_for<S, I>) {
+        auto* p = std::to_address(first);
+        const auto n = last - first;
+
+        for (std::iter_difference_t<I> i = 0; i < n; ++i) {
+          p[i] = f(p[i]);
+        }
+      } else {
+        for (; first != last; ++first) {
+          cpo::unit(first, f(*first));
+        }
+      }
+    }
+
+    /**
+    * @brief 有効な要素だけにbindするbind_valid()メンバ関数を持つ
+    */
+    template<typename M, typename F>
+    concept valid_bindable = requires(M& m, F& f) {
+      m.bind_valid(f);
+    };
+
+    /**
+    * @brief 値の連続領域と、要素ごとに1ビットの有効性ビットマップを持つ列（nullable_columnなど）
+    */
+    template<typename M>
+    concept bitmap_column = requires(const M& m) {
+      typename M::element_type;
+      { m.values() } -> std::same_as<std::span<const typename M::element_type>>;
+      { m.validity_words() } -> std::same_as<std::span<const std::uint64_t>>;
+    };
+
+    /**
+    * @brief ビットマップをワード単位で走査し、連続して有効な要素の範囲[first, last)毎にfを呼び出す
+    * @details 全ビットが立っているワードは64要素の範囲として一度に、全ビットが落ちているワードは読み飛ばす。
+    * それ以外のワードは連続するセットビット毎に範囲を切り出す。ビットマップの要素数を超える部分のビットは0でなければならない
+    */
+    template<typename F>
+    constexpr void for_each_valid_run(std::span<const std::uint64_t> words, F&& f) {
+      for (std::size_t w = 0; w < words.size(); ++w) {
+        const std::size_t base = w * 64;
+        std::uint64_t rest = words[w];
+
+        if (rest == ~std::uint64_t(0)) {
+          f(base, base + 64);
+          continue;
+        }
+
+        while (rest != 0) {
+          const int first = std::countr_zero(rest);
+          const int len = std::countr_one(rest >> first);
+
+          f(base + first, base + first + len);
+          // len == 64になるのはfirst == 0の時だけで、その場合は全ビットが立っており上で処理済み
+          rest &= ~(((std::uint64_t(1) << len) - 1) << first);
+        }
+      }
+    }
   }
 
   /**
@@ -675,10 +817,19 @@ namespace harmony {
     * @brief 保持するモナド的オブジェクトの有効値を取得
     */
     [[nodiscard]]
-    constexpr decltype(auto) operator*() noexcept(noexcept(cpo::unwrap(m_monad))) {
+    constexpr decltype(auto) operator*() & noexcept(noexcept(cpo::unwrap(m_monad))) {
       return cpo::unwrap(m_monad);
     }
 
+    /**
+    * @brief 右辺値のmonasから有効値を取得
+    * @details 保持するオブジェクトを所有している場合はムーブして取り出す、参照している場合は左辺値として取り出す
+    */
+    [[nodiscard]]
+    constexpr decltype(auto) operator*() && noexcept(noexcept(cpo::unwrap(std::forward<T>(m_monad)))) {
+      return cpo::unwrap(std::forward<T>(m_monad));
+    }
+
     /**
     * @brief 保持するモナド的オブジェクトの有効性を取得
     */
@@ -691,10 +842,19 @@ namespace harmony {
     * @brief 保持するモナド的オブジェクトの無効値を取得
     */
     [[nodiscard]]
-    constexpr decltype(auto) unwrap_err() noexcept(noexcept(cpo::unwrap_other(m_monad))) requires either<M> {
+    constexpr decltype(auto) unwrap_err() & noexcept(noexcept(cpo::unwrap_other(m_monad))) requires either<M> {
       return cpo::unwrap_other(m_monad);
     }
 
+    /**
+    * @brief 右辺値のmonasから無効値を取得
+    * @details 保持するオブジェクトを所有している場合はムーブして取り出す、参照している場合は左辺値として取り出す
+    */
+    [[nodiscard]]
+    constexpr decltype(auto) unwrap_err() && noexcept(noexcept(cpo::unwrap_other(std::forward<T>(m_monad)))) requires either<M> {
+      return cpo::unwrap_other(std::forward<T>(m_monad));
+    }
+
     /**
     * @brief 保持するモナド的オブジェクトの有効値への暗黙変換
     * @details 左辺値参照で保持しているときのオーバーロード、常に参照で返す
@@ -802,15 +962,23 @@ namespace harmony {
     */
     //template<std::invocable<std::ranges::range_reference_t<T>> F>
     template<typename F>
-      requires list<M>
+      requires list<M> and (not detail::valid_bindable<M, F>)
     friend constexpr auto operator|(monas&& self, F&& f) noexcept(detail::monadic_noexecpt_v<std::ranges::iterator_t<T>, F>) -> monas<T>&& requires monadic<F, std::ranges::iterator_t<T>> {
-      auto it = std::ranges::begin(*self);
-      const auto fin = std::ranges::end(*self);
+      auto r = *self;
+      detail::bind_elements(std::ranges::begin(r), std::ranges::end(r), f);
 
-      for (; it != fin; ++it) {
-        cpo::unit(it, f(*it));
-      }
+      return std::move(self);
+    }
 
+    /**
+    * @brief bind演算子、有効な要素だけにbindする手段を持つlistに対してのもの（either_vectorなど）
+    * @param self monas<T>のrvalue
+    * @param f Callableオブジェクト
+    */
+    template<typename F>
+      requires list<M> and detail::valid_bindable<M, F>
+    friend constexpr auto operator|(monas&& self, F&& f) -> monas<T>&& {
+      static_cast<M&>(self.m_monad).bind_valid(f);
       return std::move(self);
     }
 
@@ -891,36 +1059,242 @@ namespace harmony {
   * @brief Eitherとなる単純なラッパー
   * @tparam R 有効値の値
   * @tparam L 無効値の値
+  * @details std::variantを使わずに1バイトの判別子とunionで保持する。
+  * L, Rが共にトリビアルならばコピー・ムーブ・破棄もトリビアルになり、値の取り出しはチェックされない（validate()済みであることを仮定する）
   */
   template<typename L, typename R>
-  struct sachet {
-    std::variant<L, R> value;
-  
+  class sachet {
+    union {
+      L m_left;
+      R m_right;
+    };
+    bool m_valid;
+
+    template<typename S>
+    constexpr void construct_from(S&& other) {
+      if (other.m_valid) {
+        std::construct_at(std::addressof(m_right), std::forward<S>(other).m_right);
+      } else {
+        std::construct_at(std::addressof(m_left), std::forward<S>(other).m_left);
+      }
+    }
+
+    /**
+    * @details 保持する値の種類が異なる場合は一時オブジェクトを作ってから入れ替えるため、例外が送出されてもthisは変更されない（L, Rのムーブが例外を投げない場合）
+    */
+    template<typename S>
+    constexpr void assign_from(S&& other) {
+      if (m_valid == other.m_valid) {
+        if (m_valid) {
+          m_right = std::forward<S>(other).m_right;
+        } else {
+          m_left = std::forward<S>(other).m_left;
+        }
+      } else {
+        sachet tmp(std::forward<S>(other));
+        destroy();
+        construct_from(std::move(tmp));
+        m_valid = tmp.m_valid;
+      }
+    }
+
+    constexpr void destroy() noexcept {
+      if (m_valid) {
+        std::destroy_at(std::addressof(m_right));
+      } else {
+        std::destroy_at(std::addressof(m_left));
+      }
+    }
+
+  public:
+
+    /**
+    * @brief Lをデフォルト構築した無効値を保持する
+    */
+    constexpr sachet() noexcept(std::is_nothrow_default_constructible_v<L>)
+      requires std::default_initializable<L>
+      : m_left()
+      , m_valid(false)
+    {}
+
+    /**
+    * @brief 有効値をin-placeに構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<R, Args...>
+    constexpr explicit sachet(std::in_place_index_t<1>, Args&&... args) noexcept(std::is_nothrow_constructible_v<R, Args...>)
+      : m_right(std::forward<Args>(args)...)
+      , m_valid(true)
+    {}
+
+    /**
+    * @brief 無効値をin-placeに構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<L, Args...>
+    constexpr explicit sachet(std::in_place_index_t<0>, Args&&... args) noexcept(std::is_nothrow_constructible_v<L, Args...>)
+      : m_left(std::forward<Args>(args)...)
+      , m_valid(false)
+    {}
+
+    /**
+    * @brief L, Rのどちらか一方にだけ変換可能な値から構築する
+    */
+    template<typename U>
+      requires (not std::same_as<std::remove_cvref_t<U>, sachet>) and
+               (not std::same_as<std::remove_cvref_t<U>, std::variant<L, R>>) and
+               (std::convertible_to<U, L> != std::convertible_to<U, R>)
+    constexpr sachet(U&& v) noexcept(std::is_nothrow_constructible_v<std::conditional_t<std::convertible_to<U, R>, R, L>, U>)
+      : m_valid(std::convertible_to<U, R>)
+    {
+      if constexpr (std::convertible_to<U, R>) {
+        std::construct_at(std::addressof(m_right), std::forward<U>(v));
+      } else {
+        std::construct_at(std::addressof(m_left), std::forward<U>(v));
+      }
+    }
+
+    /**
+    * @brief std::variant<L, R>からの変換、インデックス1を有効値とする
+    */
+    template<typename V>
+      requires std::same_as<std::remove_cvref_t<V>, std::variant<L, R>>
+    constexpr sachet(V&& v)
+      : m_valid(v.index() == 1)
+    {
+      if (m_valid) {
+        std::construct_at(std::addressof(m_right), detail::variant_get<1>(std::forward<V>(v)));
+      } else {
+        std::construct_at(std::addressof(m_left), detail::variant_get<0>(std::forward<V>(v)));
+      }
+    }
+
+    constexpr sachet(const sachet&)
+      requires std::is_trivially_copy_constructible_v<L> and std::is_trivially_copy_constructible_v<R>
+      = default;
+
+    constexpr sachet(const sachet& other) noexcept(std::is_nothrow_copy_constructible_v<L> and std::is_nothrow_copy_constructible_v<R>)
+      requires std::copy_constructible<L> and std::copy_constructible<R> and
+               (not (std::is_trivially_copy_constructible_v<L> and std::is_trivially_copy_constructible_v<R>))
+      : m_valid(other.m_valid)
+    {
+      construct_from(other);
+    }
+
+    constexpr sachet(sachet&&)
+      requires std::is_trivially_move_constructible_v<L> and std::is_trivially_move_constructible_v<R>
+      = default;
+
+    constexpr sachet(sachet&& other) noexcept(std::is_nothrow_move_constructible_v<L> and std::is_nothrow_move_constructible_v<R>)
+      requires std::move_constructible<L> and std::move_constructible<R> and
+               (not (std::is_trivially_move_constructible_v<L> and std::is_trivially_move_constructible_v<R>))
+      : m_valid(other.m_valid)
+    {
+      construct_from(std::move(other));
+    }
+
+    constexpr sachet& operator=(const sachet&)
+      requires std::is_trivially_copy_assignable_v<L> and std::is_trivially_copy_assignable_v<R> and
+               std::is_trivially_copy_constructible_v<L> and std::is_trivially_copy_constructible_v<R> and
+               std::is_trivially_destructible_v<L> and std::is_trivially_destructible_v<R>
+      = default;
+
+    constexpr sachet& operator=(const sachet& other)
+      requires std::copyable<L> and std::copyable<R> and
+               (not (std::is_trivially_copy_assignable_v<L> and std::is_trivially_copy_assignable_v<R> and
+                     std::is_trivially_copy_constructible_v<L> and std::is_trivially_copy_constructible_v<R> and
+                     std::is_trivially_destructible_v<L> and std::is_trivially_destructible_v<R>))
+    {
+      if (this != std::addressof(other)) assign_from(other);
+      return *this;
+    }
+
+    constexpr sachet& operator=(sachet&&)
+      requires std::is_trivially_move_assignable_v<L> and std::is_trivially_move_assignable_v<R> and
+               std::is_trivially_move_constructible_v<L> and std::is_trivially_move_constructible_v<R> and
+               std::is_trivially_destructible_v<L> and std::is_trivially_destructible_v<R>
+      = default;
+
+    constexpr sachet& operator=(sachet&& other) noexcept(std::is_nothrow_move_constructible_v<L> and std::is_nothrow_move_constructible_v<R> and
+                                                         std::is_nothrow_move_assignable_v<L> and std::is_nothrow_move_assignable_v<R>)
+      requires std::movable<L> and std::movable<R> and
+               (not (std::is_trivially_move_assignable_v<L> and std::is_trivially_move_assignable_v<R> and
+                     std::is_trivially_move_constructible_v<L> and std::is_trivially_move_constructible_v<R> and
+                     std::is_trivially_destructible_v<L> and std::is_trivially_destructible_v<R>))
+    {
+      if (this != std::addressof(other)) assign_from(std::move(other));
+      return *this;
+    }
+
+    constexpr ~sachet()
+      requires std::is_trivially_destructible_v<L> and std::is_trivially_destructible_v<R>
+      = default;
+
+    constexpr ~sachet() {
+      destroy();
+    }
+
     [[nodiscard]]
     constexpr auto operator*() & noexcept -> R& {
-      return std::get<1>(value);
+      assert(m_valid);
+      return m_right;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator*() const & noexcept -> const R& {
+      assert(m_valid);
+      return m_right;
     }
 
     [[nodiscard]]
     constexpr auto operator*() && noexcept -> R&& {
-      return std::get<1>(std::move(value));
+      assert(m_valid);
+      return std::move(m_right);
     }
 
     [[nodiscard]]
     constexpr operator bool() const noexcept {
-      return value.index() == 1ull;
+      return m_valid;
     }
 
     [[nodiscard]]
     constexpr auto unwrap_err() & noexcept -> L& {
-      return std::get<0>(value);
+      assert(not m_valid);
+      return m_left;
+    }
+
+    [[nodiscard]]
+    constexpr auto unwrap_err() const & noexcept -> const L& {
+      assert(not m_valid);
+      return m_left;
     }
 
     [[nodiscard]]
     constexpr auto unwrap_err() && noexcept -> L&& {
-      return std::get<0>(std::move(value));
+      assert(not m_valid);
+      return std::move(m_left);
+    }
+
+    /**
+    * @brief 保持する値をstd::variant<L, R>として取り出す、インデックス1が有効値
+    */
+    [[nodiscard]]
+    constexpr auto to_variant() const & -> std::variant<L, R> {
+      if (m_valid) {
+        return std::variant<L, R>(std::in_place_index<1>, m_right);
+      } else {
+        return std::variant<L, R>(std::in_place_index<0>, m_left);
+      }
+    }
+
+    [[nodiscard]]
+    constexpr auto to_variant() && -> std::variant<L, R> {
+      if (m_valid) {
+        return std::variant<L, R>(std::in_place_index<1>, std::move(m_right));
+      } else {
+        return std::variant<L, R>(std::in_place_index<0>, std::move(m_left));
+      }
     }
-    
   };
 
   /**
@@ -973,6 +1347,32 @@ namespace harmony::inline concepts {
     not std::same_as<void, std::invoke_result_t<F, Arg>>;
 }
 
+namespace harmony::traits {
+
+  namespace impl {
+    template<typename M>
+    struct monas_value {};
+
+    template<typename T>
+    struct monas_value<monas<T>> {
+      using type = std::remove_cvref_t<T>;
+      using arg = T;
+    };
+  }
+
+  /**
+  * @brief monas<T>の保持するモナド的な型を得る（参照は外す）
+  */
+  template<typename M>
+  using monas_value_t = typename impl::monas_value<M>::type;
+
+  /**
+  * @brief monas<T>のTを得る（参照はそのまま）
+  */
+  template<typename M>
+  using monas_arg_t = typename impl::monas_value<M>::arg;
+}
+
 namespace harmony::detail {
 
   template<typename F>
@@ -1012,854 +1412,5292 @@ namespace harmony::inline monadic_op{
 
 namespace harmony::detail {
 
-  template<typename F, typename M, typename R>
-  consteval bool check_nothrow_map() {
-    bool common = noexcept(cpo::unwrap(std::declval<M>())) and std::is_nothrow_invocable_v<F, traits::unwrap_t<M>>;
-    if constexpr (unwrappable<R>) {
-      return common and std::is_nothrow_constructible_v<monas<R>, R>;
-    } else {
-      return common and std::is_nothrow_constructible_v<monas<sachet<nil, std::remove_cvref_t<R>>>, R>;
-    }
+  /**
+  * @brief executorコンセプトの判定に使用する、引数なしのCallable
+  */
+  struct executor_probe {
+    void operator()() const noexcept {}
+  };
+
+} // namespace harmony::detail
+
+namespace harmony::inline concepts {
+
+  /**
+  * @brief 引数なしのCallableをexecute()で受け取り、どこかで実行する型
+  */
+  template<typename E>
+  concept executor = requires(E& e, detail::executor_probe f) {
+    e.execute(f);
+  };
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief 並列実行に使用するワーカー数を得る
+  */
+  inline auto hardware_workers() noexcept -> std::size_t {
+    const std::size_t n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
   }
-  
-  template<typename From, typename To>
-  inline constexpr bool is_ptr_to_opt_v = false;
-  
-  template<typename T>
-  inline constexpr bool is_ptr_to_opt_v<std::nullptr_t, std::optional<T>> = true;
 
+  /**
+  * @brief parallel_chunksの1回の呼び出し、チャンクを1つずつ取り出して処理する
+  * @details 呼び出しスレッドもexecutorに投げた処理も同じようにチャンクを取り出すので、executorが処理を始めなくても全てのチャンクが処理される。
+  * 全てのチャンクが取り出された後に始まった処理は何もせずに終わるので、呼び出しスレッドが戻った後に実行されてもよい
+  */
+  class parallel_job {
+    std::atomic<std::size_t> m_next{0};
+    std::atomic<std::size_t> m_done{0};
+    const std::size_t m_count;
+
+    /**
+    * @brief i番目のチャンクを処理する
+    */
+    virtual void run(std::size_t i) noexcept = 0;
 
-  template<typename F>
-  struct map_impl {
+  public:
 
-    [[no_unique_address]] F fmap;
+    explicit parallel_job(std::size_t count) noexcept
+      : m_count(count)
+    {}
 
-    template<unwrappable M>
-      requires detail::map_reusable<F&, M> and
-               not_void_resulted<F, traits::unwrap_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) noexcept(noexcept(std::forward<M>(m).map(self.fmap))) {
-      return monas(std::forward<M>(m).map(self.fmap));
+    virtual ~parallel_job() = default;
+
+    /**
+    * @brief チャンクが無くなるまで取り出して処理する
+    */
+    void work() noexcept {
+      for (std::size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count; i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+        run(i);
+        if (m_done.fetch_add(1, std::memory_order_acq_rel) + 1 == m_count) {
+          m_done.notify_all();
+        }
+      }
     }
 
-    template<bool monadic_return, typename T>
-    constexpr auto invoke_impl(T&& v) {
-      if constexpr (monadic_return) {
-        // map結果がモナド的な型の値ならば、単にmonasで包んで返す
-        return monas(this->fmap(std::forward<T>(v)));
-      } else {
-        // map結果はモナド的な型ではない時、sachetで包んでmonasで包んで返す
-        return monas(sachet{ .value = this->fmap(std::forward<T>(v)) });
+    /**
+    * @brief 全てのチャンクの処理が終わるまで待機する
+    */
+    void wait() const noexcept {
+      for (std::size_t done = m_done.load(std::memory_order_acquire); done != m_count; done = m_done.load(std::memory_order_acquire)) {
+        m_done.wait(done, std::memory_order_acquire);
       }
     }
+  };
 
-    template<unwrappable M>
-      requires not_void_resulted<F, traits::unwrap_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) noexcept(check_nothrow_map<F, M, std::invoke_result_t<F, traits::unwrap_t<M>>>()) {
-      return self.invoke_impl<unwrappable<std::invoke_result_t<F, traits::unwrap_t<M>>>>(cpo::unwrap(std::forward<M>(m)));
+  /**
+  * @brief 並列処理のワーカーを動かすexecutorへの参照、既定ではshared_pool()を使用する
+  * @details 並列処理を行う操作が型に依らずexecutorを保持できるように、型を消去して参照する
+  */
+  class parallel_executor_ref {
+    void* m_exec = nullptr;
+    void (*m_submit)(void*, std::shared_ptr<parallel_job>) = nullptr;
+
+    template<typename E>
+    static void submit_to(void* exec, std::shared_ptr<parallel_job> job) {
+      static_cast<E*>(exec)->execute([job = std::move(job)] { job->work(); });
     }
 
-    template<either M>
-      requires detail::not_map_reusable<F&, M> and
-               not_void_resulted<F, traits::unwrap_t<M>> and
-               either<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_t<M>>>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) {
-      using result_t = std::remove_cv_t<std::invoke_result_t<F, traits::unwrap_t<M>>>;
+  public:
 
-      if (cpo::validate(m)) {
-        return monas<result_t>(self.fmap(cpo::unwrap(std::forward<M>(m))));
-      } else {
-        // 無効値の変換処理
-        if constexpr (is_ptr_to_opt_v<std::remove_cvref_t<traits::unwrap_other_t<M>>, result_t>) {
-          // nullptr -> nulloptへの無効値の変換（利便性のための特殊対応）
-          return monas<result_t>(std::nullopt);
-        } else {
-          static_assert(std::constructible_from<result_t, traits::unwrap_other_t<M>>, "Cannot convert left value type");
-          // その他デフォルト、そのまま構築を試みる
-          return monas<result_t>(cpo::unwrap_other(std::forward<M>(m)));
-        }
-      }
-    }
-    
-    template<either M>
-      requires detail::not_map_reusable<F&, M> and
-               not_void_resulted<F, traits::unwrap_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) {
-      // 有効値の型
-      using R = std::remove_cvref_t<std::invoke_result_t<F, traits::unwrap_t<M>>>;
-      // 無効値の型
-      using L = std::remove_cvref_t<traits::unwrap_other_t<M>>;
-      
-      if (cpo::validate(m)) {
-        return monas<sachet<L, R>>(std::in_place, std::variant<L, R>(std::in_place_index<1>, self.fmap(cpo::unwrap(std::forward<M>(m)))));
-      } else {
-        return monas<sachet<L, R>>(std::in_place, std::variant<L, R>(std::in_place_index<0>, cpo::unwrap_other(std::forward<M>(m))));
-      }
-    }
-  };
-
-  template<typename F>
-  map_impl(F&&) -> map_impl<F>;
+    parallel_executor_ref() = default;
 
-} // namespace harmony::detail
+    template<executor E>
+    explicit parallel_executor_ref(E& exec) noexcept
+      : m_exec(std::addressof(exec))
+      , m_submit(&submit_to<E>)
+    {}
 
-namespace harmony::inline monadic_op {
+    /**
+    * @brief jobを処理するワーカーを1つexecutorに投げる
+    */
+    void submit(std::shared_ptr<parallel_job> job) const;
+  };
 
   /**
-  * @brief モナド的な型に対してmapを適用する（有効値を任意の型の値へ写す）
-  * @brief M<T, E>のような型をM<U, E>のように変換する
-  * @param f T -> U へmapするCallableオブジェクト
+  * @brief [0, size)をワーカー数分のチャンクに分割し、fn(first, last)をexecutor上で並列に呼び出す
+  * @details 1ワーカーあたりgrain個未満の要素しかない場合はexecutorを使わずに呼び出しスレッドで処理する。
+  * 呼び出しスレッドもチャンクを処理するので、executorのワーカー上から呼び出してもデッドロックしない
+  * @details ワーカーで送出された例外は全チャンクの終了後に呼び出しスレッドで再送出する（最初のチャンクのものを優先）
+  * @param exec ワーカーを動かすexecutor
+  * @param size 処理する要素数
+  * @param grain 1ワーカーが担当する最小要素数
+  * @param fn 半開区間[first, last)を受け取るCallableオブジェクト
   */
-  inline constexpr auto map = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::map_impl<F> {
-    return detail::map_impl{ .fmap = std::forward<F>(f) };
-  };
+  template<typename Fn>
+  void parallel_chunks(parallel_executor_ref exec, std::size_t size, std::size_t grain, Fn&& fn) {
+    const std::size_t max_workers = (size + grain - 1) / (grain == 0 ? 1 : grain);
+    const std::size_t workers = std::min(hardware_workers(), max_workers);
+
+    if (workers <= 1) {
+      fn(std::size_t(0), size);
+      return;
+    }
 
-  inline constexpr auto& transform = map;
+    class job final : public parallel_job {
+      Fn& m_fn;
+      const std::size_t m_chunk;
+      const std::size_t m_rem;
 
-} // namespace harmony::inline monadic_op
+      // i番目のチャンクの先頭位置、余りは先頭側のチャンクに1つづつ割り振る
+      auto chunk_begin(std::size_t i) const noexcept -> std::size_t {
+        return i * m_chunk + std::min(i, m_rem);
+      }
 
+      void run(std::size_t i) noexcept override {
+#ifdef HARMONY_NO_EXCEPTIONS
+        m_fn(chunk_begin(i), chunk_begin(i + 1));
+#else
+        try {
+          m_fn(chunk_begin(i), chunk_begin(i + 1));
+        } catch (...) {
+          errors[i] = std::current_exception();
+        }
+#endif
+      }
 
-namespace harmony::detail {
+    public:
+#ifndef HARMONY_NO_EXCEPTIONS
+      std::vector<std::exception_ptr> errors;
+#endif
 
-  template<typename F, typename M>
-  constexpr bool check_nothrow_reuse_map_err() {
-    if constexpr (detail::map_err_reusable<F&, M>) {
-      return noexcept(std::declval<M>().map_err(std::declval<F>()));
-    } else {
-      return noexcept(std::declval<M>().map_error(std::declval<F>()));
+      job(Fn& fn, std::size_t size, std::size_t workers)
+        : parallel_job(workers)
+        , m_fn(fn)
+        , m_chunk(size / workers)
+        , m_rem(size % workers)
+#ifndef HARMONY_NO_EXCEPTIONS
+        , errors(workers)
+#endif
+      {}
+    };
+
+    const auto state = std::make_shared<job>(fn, size, workers);
+
+    for (std::size_t i = 1; i < workers; ++i) {
+#ifdef HARMONY_NO_EXCEPTIONS
+      exec.submit(state);
+#else
+      try {
+        exec.submit(state);
+      } catch (...) {
+        // 投げられなかった分のチャンクは呼び出しスレッドが処理する
+        break;
+      }
+#endif
+    }
+
+    state->work();
+    state->wait();
+
+#ifndef HARMONY_NO_EXCEPTIONS
+    for (auto& e : state->errors) {
+      if (e) std::rethrow_exception(e);
     }
+#endif
   }
 
-  template<typename F, typename M>
-  concept map_err_func_reusable = map_err_reusable<F, M> or map_error_reusable<F, M>;
+  /**
+  * @brief listの各要素に対してfをbindできる
+  * @details 要素単位の判定のみを行い、range全体に対するfの呼び出し可能性は調べない（ジェネリックラムダの本体を範囲型で実体化させないため）
+  */
+  template<typename R, typename F>
+  concept element_bindable =
+    list<std::remove_cvref_t<R>> and
+    monadic<F&, std::ranges::iterator_t<std::remove_reference_t<R>>>;
 
-  template<typename F, typename M>
-  concept not_map_err_func_reusable = not map_err_func_reusable<F, M>;
+  /**
+  * @brief 左辺をmonasで包んでからbindできる、monas以外の型
+  */
+  template<typename M, typename F>
+  concept wrap_bindable =
+    unwrappable<M> and
+    (not specialization_of<std::remove_cvref_t<M>, monas>) and
+    (element_bindable<M, F> or requires(M&& m, F& f) { monas(std::forward<M>(m)) | f; });
 
+  /**
+  * @brief 並列bindが可能なlist
+  */
+  template<typename R>
+  concept parallel_list =
+    list<std::remove_cvref_t<R>> and
+    std::ranges::random_access_range<std::remove_reference_t<R>> and
+    std::ranges::sized_range<std::remove_reference_t<R>>;
 
   template<typename F>
-  struct map_err_impl {
-
+  struct par_then_impl {
     [[no_unique_address]] F fmap;
+    std::size_t grain;
+    parallel_executor_ref exec{};
 
-    template<either M>
-      requires map_err_func_reusable<F&, M> and
-               not_void_resulted<F, traits::unwrap_other_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_err_impl self) noexcept(check_nothrow_reuse_map_err<F&, M>()) {
-      if constexpr (map_err_reusable<F&, M>) {
-        return monas(std::forward<M>(m).map_err(self.fmap));
-      } else {
-        return monas(std::forward<M>(m).map_error(self.fmap));
-      }
-    }
+    /**
+    * @brief listに対して要素ごとにbindする、ランダムアクセス可能ならば要素を分割し並列に処理する
+    */
+    template<typename T>
+      requires element_bindable<T, F>
+    friend constexpr auto operator|(monas<T>&& m, par_then_impl self) -> monas<T> {
+      auto r = *m;
 
-    template<either M>
-      requires not_map_err_func_reusable<F&, M> and
-               not_void_resulted<F, traits::unwrap_other_t<M>> and
-               either<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_err_impl self) {
-      using result_t = std::remove_cv_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>;
+      if constexpr (parallel_list<T>) {
+        const auto first = std::ranges::begin(r);
+        using diff_t = std::ranges::range_difference_t<decltype(r)>;
 
-      if (cpo::validate(m)) {
-        static_assert(std::constructible_from<result_t, traits::unwrap_t<M>>, "Cannot convert right value type");
-        // そのまま構築を試みる
-        return monas<result_t>(cpo::unwrap(std::forward<M>(m)));
+        parallel_chunks(self.exec, static_cast<std::size_t>(std::ranges::size(r)), self.grain, [&](std::size_t b, std::size_t e) {
+          bind_elements(first + static_cast<diff_t>(b), first + static_cast<diff_t>(e), self.fmap);
+        });
       } else {
-        return monas<result_t>(self.fmap(cpo::unwrap_other(std::forward<M>(m))));
+        // 並列化できないlistは呼び出しスレッドで処理する
+        bind_elements(std::ranges::begin(r), std::ranges::end(r), self.fmap);
       }
+
+      return std::move(m);
     }
-    
-    template<either M>
-      requires not_map_err_func_reusable<F&, M> and
-               not_void_resulted<F, traits::unwrap_other_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, map_err_impl self) {
-      // 有効値の型
-      using R = std::remove_cvref_t<traits::unwrap_t<M>>;
-      // 無効値の型
-      using L = std::remove_cvref_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>;
-      
-      if (cpo::validate(m)) {
-        return monas<sachet<L, R>>(std::in_place, std::variant<L, R>(std::in_place_index<1>, cpo::unwrap(std::forward<M>(m))));
-      } else {
-        return monas<sachet<L, R>>(std::in_place, std::variant<L, R>(std::in_place_index<0>, self.fmap(cpo::unwrap_other(std::forward<M>(m)))));
-      }
+
+    /**
+    * @brief listでない型に対しては通常のbindにフォールバックする
+    */
+    template<typename T>
+      requires (not list<std::remove_cvref_t<T>>) and
+               requires(monas<T>&& m, F& f) { std::move(m) | f; }
+    friend constexpr specialization_of<monas> auto operator|(monas<T>&& m, par_then_impl self) {
+      return std::move(m) | self.fmap;
     }
 
+    template<wrap_bindable<F> M>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, par_then_impl self) {
+      return monas(std::forward<M>(m)) | std::move(self);
+    }
   };
 
-  template<typename F>
-  map_err_impl(F&&) -> map_err_impl<F>;
+  /**
+  * @brief 並列bindの1ワーカーあたりのデフォルトの最小要素数
+  */
+  inline constexpr std::size_t default_parallel_grain = 1 << 15;
 
 } // namespace harmony::detail
 
 namespace harmony::inline monadic_op {
 
   /**
-  * @brief Eitherモナドな型に対してmap_errを適用する（無効地を任意の型の値へ写す）
-  * @brief M<T, E>のような型をM<T, F>のように変換する（Either<L, R>をEither<M, R>へ変換する）
-  * @param f E -> F へmapするCallableオブジェクト
+  * @brief listの各要素に対するbindを複数スレッドで分割して行う
+  * @details ランダムアクセス可能かつサイズを求められるlistの時にのみ並列化し、それ以外の場合は通常のbind（then）と同じ振る舞いになる
+  * @details fは複数のスレッドから同時に呼び出される
+  * @param f bindするCallableオブジェクト
+  * @param grain 1スレッドが担当する最小要素数、要素数がこれに満たない場合は呼び出しスレッドで処理される
+  * @param exec ワーカーを動かすexecutor（省略可能）、参照で保持する。省略した場合はプロセスで共有するthread_poolを使用する
   */
-  inline constexpr auto map_err = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::map_err_impl<F> {
-    return detail::map_err_impl{ .fmap = std::forward<F>(f) };
+  inline constexpr auto par_then = []<typename F, executor... E>(F&& f, std::size_t grain = detail::default_parallel_grain, E&... exec) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::par_then_impl<F>
+    requires (sizeof...(E) <= 1)
+  {
+    return detail::par_then_impl<F>{ .fmap = std::forward<F>(f), .grain = grain, .exec = detail::parallel_executor_ref(exec...) };
   };
+}
 
-} // namespace harmony::inline monadic_op
+namespace harmony::detail {
 
+#ifdef __cpp_lib_experimental_parallel_simd
 
-namespace harmony::detail {
+  template<typename V>
+  using native_simd_t = std::experimental::native_simd<V>;
 
-  template<typename F, typename M, typename R = std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_t<M>>>>
-  inline constexpr bool check_nothrow_and_then_v =
-    std::is_nothrow_invocable_v<F, traits::unwrap_t<M>> and
-    std::is_nothrow_constructible_v<monas<R>, R> and
-    std::is_nothrow_constructible_v<monas<R>, traits::unwrap_other_t<M>>;
-  
+  /**
+  * @brief fはVのsimd型を受けてsimd型を返すことができる
+  */
+  template<typename F, typename V>
+  concept simd_invocable =
+    std::is_arithmetic_v<V> and
+    (not std::same_as<V, bool>) and
+    std::invocable<F&, native_simd_t<V>> and
+    std::convertible_to<std::invoke_result_t<F&, native_simd_t<V>>, native_simd_t<V>>;
 
+#else
 
-  template<typename F>
-  struct and_then_impl {
+  template<typename F, typename V>
+  concept simd_invocable = false;
+
+#endif
+
+  /**
+  * @brief 明示的にベクトル化されたbindが可能なlist
+  */
+  template<typename R, typename F>
+  concept simd_bindable_list =
+    list<std::remove_cvref_t<R>> and
+    std::ranges::contiguous_range<std::remove_reference_t<R>> and
+    std::ranges::sized_range<std::remove_reference_t<R>> and
+    simd_invocable<F, std::ranges::range_value_t<std::remove_reference_t<R>>> and
+    std::invocable<F&, std::ranges::range_value_t<std::remove_reference_t<R>>&>;
 
+  template<typename F>
+  struct simd_then_impl {
     [[no_unique_address]] F fmap;
-    
-    template<either M>
-      requires not_and_then_reusable<F&, M> and
-               std::invocable<F, traits::unwrap_t<M>> and
-               either<std::invoke_result_t<F, traits::unwrap_t<M>>> and
-               std::constructible_from<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_t<M>>>, traits::unwrap_other_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, and_then_impl self) noexcept(noexcept(cpo::validate(m)) and check_nothrow_and_then_v<F, M>) {
-      // 呼び出し結果が左辺値参照を返すとき、コピーされることになる
-      // mが有効値を保持していないとき、戻り値のmonasはmの無効値をムーブするしかない（参照するのは危険）
-      //using ret_either_t = std::remove_reference_t<decltype(self.fmap(cpo::unwrap(std::forward<M>(m))))>;
-      using result_t = std::remove_cvref_t<std::invoke_result_t<F&, traits::unwrap_t<M>>>;
 
-      if (cpo::validate(m)) {
-        return monas<result_t>(self.fmap(cpo::unwrap(std::forward<M>(m))));
-      } else {
-        static_assert(std::constructible_from<result_t, traits::unwrap_other_t<M>>, "Cannot convert left value type");
-        return monas<result_t>(cpo::unwrap_other(std::forward<M>(m)));
+    /**
+    * @brief listに対して要素ごとにbindする
+    * @details 算術型の連続範囲ならば、simd幅ごとにまとめてfを適用し、端数はスカラで処理する
+    */
+    template<typename T>
+      requires element_bindable<T, F>
+    friend auto operator|(monas<T>&& m, simd_then_impl self) -> monas<T> {
+      auto r = *m;
+
+#ifdef __cpp_lib_experimental_parallel_simd
+      if constexpr (simd_bindable_list<T, F>) {
+        using V = std::ranges::range_value_t<std::remove_reference_t<T>>;
+        using simd_t = native_simd_t<V>;
+        namespace stdx = std::experimental;
+
+        V* p = std::ranges::data(r);
+        const std::size_t n = static_cast<std::size_t>(std::ranges::size(r));
+        const std::size_t vec_end = n - n % simd_t::size();
+
+        std::size_t i = 0;
+        for (; i < vec_end; i += simd_t::size()) {
+          simd_t x(p + i, stdx::element_aligned);
+          x = self.fmap(x);
+          x.copy_to(p + i, stdx::element_aligned);
+        }
+        for (; i < n; ++i) {
+          p[i] = self.fmap(p[i]);
+        }
+
+        return std::move(m);
       }
+#endif
+      bind_elements(std::ranges::begin(r), std::ranges::end(r), self.fmap);
+
+      return std::move(m);
     }
 
-    template<either M>
-      requires and_then_reusable<F&, M>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, and_then_impl self) noexcept(noexcept(monas(std::forward<M>(m).and_then(self.fmap)))) {
-      return monas(std::forward<M>(m).and_then(self.fmap));
+    /**
+    * @brief listでない型に対しては通常のbindにフォールバックする
+    */
+    template<typename T>
+      requires (not list<std::remove_cvref_t<T>>) and
+               requires(monas<T>&& m, F& f) { std::move(m) | f; }
+    friend constexpr specialization_of<monas> auto operator|(monas<T>&& m, simd_then_impl self) {
+      return std::move(m) | self.fmap;
+    }
+
+    template<wrap_bindable<F> M>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, simd_then_impl self) {
+      return monas(std::forward<M>(m)) | std::move(self);
     }
   };
-  
-  template<typename F>
-  and_then_impl(F&&) -> and_then_impl<F>;
-}
+
+} // namespace harmony::detail
 
 namespace harmony::inline monadic_op {
 
   /**
-  * @brief Eitherモナドな型の有効値をmapした別のEither型へ変換する（有効値だけを変換し、無効値はそのまま）
-  * @brief M<T, E>のような型をN<U, E>のように変換する（Either1<L, R>をEither2<L, S>へ変換する）
-  * @param f T -> N<U, E> へmapするCallableオブジェクト（戻り値型はEitherを返さなければならない）
+  * @brief 算術型の連続範囲に対するbindを、std::experimental::simdによって明示的にベクトル化して行う
+  * @details fはスカラ値（端数の処理に使用）とnative_simd<T>のどちらでも呼び出し可能である必要がある（ジェネリックラムダなど）
+  * @details std::experimental::simdが利用できない場合やfがsimd型を受け取れない場合は、通常のbind（then）と同じ振る舞いになる
+  * @param f bindするCallableオブジェクト
   */
-  inline constexpr auto and_then = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::and_then_impl<F> {
-    return detail::and_then_impl{ .fmap = std::forward<F>(f) };
+  inline constexpr auto simd_then = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::simd_then_impl<F> {
+    return detail::simd_then_impl<F>{ .fmap = std::forward<F>(f) };
   };
 }
 
-
 namespace harmony::detail {
 
-  template<typename F, typename M, typename R = std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>>
-  inline constexpr bool check_nothrow_or_else_v =
-    std::is_nothrow_invocable_v<F, traits::unwrap_other_t<M>> and
-    std::is_nothrow_constructible_v<monas<R>, R> and
-    std::is_nothrow_constructible_v<monas<R>, traits::unwrap_t<M>>;
+  /**
+  * @brief maybeな型であり、その有効値からTを構築できる
+  */
+  template<typename M, typename T>
+  concept maybe_constructible_to =
+    maybe<M> and
+    std::constructible_from<T, traits::unwrap_t<M>>;
 
+  /**
+  * @brief 複数のbindを1つにまとめて実行する
+  * @details 最初に1度だけ有効性をチェックし、途中の結果はmonasに書き戻さずに一時オブジェクトとして次の関数に渡す
+  * @details 途中の関数がmaybeな型を返した場合はその有効性をチェックし、無効であればmへ再代入して終了する（通常のbindと同じく短絡評価される）
+  */
+  template<typename... Fs>
+  struct fused_impl {
+    std::tuple<Fs...> fmaps;
 
-  template<typename F>
-  struct or_else_impl {
+    /**
+    * @brief I番目の関数を適用する
+    * @tparam InM vがmの保持する値を参照しているか
+    */
+    template<std::size_t I, bool InM, typename M, typename V>
+    constexpr void run(M& m, V& v) {
+      auto& f = std::get<I>(fmaps);
+      using R = std::invoke_result_t<decltype(f), V&>;
+      using value_t = std::remove_cvref_t<traits::unwrap_t<M&>>;
+
+      if constexpr (std::same_as<R, void>) {
+        // 戻り値のない関数はbindと同様に値をそのまま次へ渡す
+        f(v);
+
+        if constexpr (I + 1 < sizeof...(Fs)) {
+          this->run<I + 1, InM>(m, v);
+        } else if constexpr (not InM) {
+          cpo::unit(m, std::move(v));
+        }
+      } else if constexpr (I + 1 == sizeof...(Fs)) {
+        // 最後の結果だけをmへ再代入する
+        cpo::unit(m, f(v));
+      } else if constexpr (unwrap_and_assignable<M, R> and std::constructible_from<value_t, R>) {
+        // unitが有効値への代入となる場合、結果を有効値の型の一時オブジェクトとして保持する
+        value_t tmp(f(v));
+        this->run<I + 1, false>(m, tmp);
+      } else if constexpr (maybe_constructible_to<R, value_t>) {
+        // unitがm自体への代入となる場合、有効値を持つかだけをチェックする
+        R r = f(v);
+        if (not cpo::validate(r)) {
+          cpo::unit(m, std::move(r));
+          return;
+        }
+        value_t tmp(cpo::unwrap(std::move(r)));
+        this->run<I + 1, false>(m, tmp);
+      } else {
+        // それ以外の場合は通常のbindと同じくmへ再代入してからチェックする
+        cpo::unit(m, f(v));
 
-    [[no_unique_address]] F fmap;
+        if constexpr (maybe<M>) {
+          if (not cpo::validate(m)) return;
+        }
+        decltype(auto) next = cpo::unwrap(m);
+        this->run<I + 1, true>(m, next);
+      }
+    }
 
-    template<either M>
-      requires not_or_else_reusable<F&, M> and
-               std::invocable<F, traits::unwrap_other_t<M>> and
-               either<std::invoke_result_t<F, traits::unwrap_other_t<M>>> and
-               std::constructible_from<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>, traits::unwrap_t<M>>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, or_else_impl self) noexcept(noexcept(cpo::validate(m)) and check_nothrow_or_else_v<F, M>) {
-      // 呼び出し結果が左辺値参照を返すとき、コピーされることになる
-      // mが有効値を保持しているとき、戻り値のmonasはmの有効値をムーブするしかない（参照するのは危険）
-      //using ret_either_t = std::remove_reference_t<decltype(self.fmap(cpo::unwrap_other(std::forward<M>(m))))>;
-      using result_t = std::remove_cvref_t<std::invoke_result_t<F &, traits::unwrap_other_t<M>>>;
+    /**
+    * @brief run<I, InM>(m, v)の各段階が呼び出し可能で、その結果をmへ再代入できるかを、runと同じ分岐で調べる
+    */
+    template<std::size_t I, bool InM, typename M, typename V>
+    static consteval bool runnable() {
+      using F = std::tuple_element_t<I, std::tuple<Fs...>>&;
 
-      if (cpo::validate(m)) {
-        static_assert(std::constructible_from<result_t, traits::unwrap_t<M>>, "Cannot convert right value type");
-        return monas<result_t>(cpo::unwrap(std::forward<M>(m)));
+      if constexpr (not std::invocable<F, V&>) {
+        return false;
       } else {
-        return monas<result_t>(self.fmap(cpo::unwrap_other(std::forward<M>(m))));
+        using R = std::invoke_result_t<F, V&>;
+        using value_t = std::remove_cvref_t<traits::unwrap_t<M&>>;
+
+        if constexpr (std::same_as<R, void>) {
+          if constexpr (I + 1 < sizeof...(Fs)) {
+            return runnable<I + 1, InM, M, V>();
+          } else if constexpr (not InM) {
+            return requires(M& m, V& v) { cpo::unit(m, std::move(v)); };
+          } else {
+            return true;
+          }
+        } else if constexpr (I + 1 == sizeof...(Fs)) {
+          return requires(M& m, R&& r) { cpo::unit(m, std::forward<R>(r)); };
+        } else if constexpr (unwrap_and_assignable<M, R> and std::constructible_from<value_t, R>) {
+          return runnable<I + 1, false, M, value_t>();
+        } else if constexpr (maybe_constructible_to<R, value_t>) {
+          if constexpr (requires(M& m, R&& r) { cpo::unit(m, std::move(r)); }) {
+            return runnable<I + 1, false, M, value_t>();
+          } else {
+            return false;
+          }
+        } else if constexpr (requires(M& m, R&& r) { cpo::unit(m, std::forward<R>(r)); }) {
+          return runnable<I + 1, true, M, std::remove_reference_t<decltype(cpo::unwrap(std::declval<M&>()))>>();
+        } else {
+          return false;
+        }
       }
     }
 
-    template<either M>
-      requires or_else_reusable<F&, M>
-    friend constexpr specialization_of<monas> auto operator|(M&& m, or_else_impl self) noexcept(noexcept(monas(std::forward<M>(m).or_else(self.fmap)))) {
-      return monas(std::forward<M>(m).or_else(self.fmap));
-    }
-    
-  };
-  
-  template<typename F>
-  or_else_impl(F&&) -> or_else_impl<F>;
+    template<typename T>
+      requires (not list<std::remove_cvref_t<T>>) and
+               unwrappable<std::remove_reference_t<T>&> and
+               (runnable<0, true, std::remove_reference_t<T>, std::remove_reference_t<decltype(cpo::unwrap(std::declval<std::remove_reference_t<T>&>()))>>())
+    friend constexpr auto operator|(monas<T>&& m, fused_impl self) -> monas<T> {
+      using M = std::remove_reference_t<T>;
+      M& bound = m;
+
+      if constexpr (maybe<M>) {
+        if (not cpo::validate(bound)) return std::move(m);
+      }
 
-} // namespace harmony::detail
+      decltype(auto) v = cpo::unwrap(bound);
+      self.run<0, true>(bound, v);
+
+      return std::move(m);
+    }
+
+    template<unwrappable M>
+      requires (not specialization_of<std::remove_cvref_t<M>, monas>) and
+               requires(M&& m, fused_impl& self) { monas(std::forward<M>(m)) | std::move(self); }
+    friend constexpr specialization_of<monas> auto operator|(M&& m, fused_impl self) {
+      return monas(std::forward<M>(m)) | std::move(self);
+    }
+  };
+
+} // namespace harmony::detail
 
 namespace harmony::inline monadic_op {
 
   /**
-  * @brief Eitherモナドな型の無効値をmapした別のEither型へ変換する（無効値だけを変換し、有効値はそのまま）
-  * @brief M<T, E>のような型をN<T, F>のように変換する（Either1<L, R>をEither2<L, S>へ変換する）
-  * @param f E -> N<T, F> へmapするCallableオブジェクト（戻り値型はEitherを返さなければならない）
+  * @brief 複数のCallableのbindを融合し、1回の有効性チェックと1回の再代入で実行する
+  * @details monas(m) | f | g | h と同じ結果になる（ただし、途中の結果はmへ書き戻されない）
+  * @param fs 順番に適用するCallableオブジェクト
   */
-  inline constexpr auto or_else = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::or_else_impl<F> {
-    return detail::or_else_impl{ .fmap = std::forward<F>(f) };
+  inline constexpr auto fused = []<typename... Fs>(Fs&&... fs) noexcept((std::is_nothrow_move_constructible_v<Fs> and ...)) -> detail::fused_impl<Fs...> {
+    static_assert(sizeof...(Fs) != 0, "At least one callable is required.");
+    return detail::fused_impl<Fs...>{ .fmaps = std::tuple<Fs...>(std::forward<Fs>(fs)...) };
   };
 }
 
 namespace harmony::detail {
 
-  template<typename Fok, typename Ferr>
-  struct match_impl {
-    [[no_unique_address]] Fok  fmap_ok;
-    [[no_unique_address]] Ferr fmap_err;
+  template<typename F, typename M, typename R>
+  consteval bool check_nothrow_map() {
+    bool common = noexcept(cpo::unwrap(std::declval<M>())) and std::is_nothrow_invocable_v<F, traits::unwrap_t<M>>;
+    if constexpr (unwrappable<R>) {
+      return common and std::is_nothrow_constructible_v<monas<R>, R>;
+    } else {
+      return common and std::is_nothrow_constructible_v<monas<sachet<nil, std::remove_cvref_t<R>>>, R>;
+    }
+  }
+  
+  template<typename From, typename To>
+  inline constexpr bool is_ptr_to_opt_v = false;
+  
+  template<typename T>
+  inline constexpr bool is_ptr_to_opt_v<std::nullptr_t, std::optional<T>> = true;
 
-    template<typename R, typename M, typename Fe>
-    constexpr auto invoke_impl(M&& m, Fe& ferr) {
-      if constexpr (unwrappable<R>) {
-        if (cpo::validate(m)) {
-          return monas<R>(this->fmap_ok(cpo::unwrap(std::forward<M>(m))));
-        } else {
-          return monas<R>(ferr(cpo::unwrap_other(std::forward<M>(m))));
-        }
+
+  template<typename F>
+  struct map_impl {
+
+    [[no_unique_address]] F fmap;
+
+    template<unwrappable M>
+      requires detail::map_reusable<F&, M> and
+               not_void_resulted<F, traits::unwrap_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) noexcept(noexcept(std::forward<M>(m).map(self.fmap))) {
+      return monas(std::forward<M>(m).map(self.fmap));
+    }
+
+    template<bool monadic_return, typename T>
+    constexpr auto invoke_impl(T&& v) {
+      if constexpr (monadic_return) {
+        // map結果がモナド的な型の値ならば、単にmonasで包んで返す
+        return monas(this->fmap(std::forward<T>(v)));
       } else {
-        // なぜかR=voidの時もこのまま動くらしい（本当にポータブル？）
-        if (cpo::validate(m)) {
-          return static_cast<R>(this->fmap_ok(cpo::unwrap(std::forward<M>(m))));
-        } else {
-          return static_cast<R>(ferr(cpo::unwrap_other(std::forward<M>(m))));
-        }
+        // map結果はモナド的な型ではない時、sachetで包んでmonasで包んで返す
+        return monas(sachet{ .value = this->fmap(std::forward<T>(v)) });
       }
     }
 
+    template<unwrappable M>
+      requires not_void_resulted<F, traits::unwrap_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) noexcept(check_nothrow_map<F, M, std::invoke_result_t<F, traits::unwrap_t<M>>>()) {
+      return self.invoke_impl<unwrappable<std::invoke_result_t<F, traits::unwrap_t<M>>>>(cpo::unwrap(std::forward<M>(m)));
+    }
 
     template<either M>
-      requires std::invocable<Fok, traits::unwrap_t<M>> and
-               std::invocable<Ferr, traits::unwrap_other_t<M>> and
-               std::common_with<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Ferr, traits::unwrap_other_t<M>>>
-    friend constexpr auto operator|(M&& m, match_impl self) {
-      using result_t = std::common_type_t<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Ferr, traits::unwrap_other_t<M>>>;
+      requires detail::not_map_reusable<F&, M> and
+               not_void_resulted<F, traits::unwrap_t<M>> and
+               either<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_t<M>>>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) {
+      using result_t = std::remove_cv_t<std::invoke_result_t<F, traits::unwrap_t<M>>>;
 
-      return self.invoke_impl<result_t>(std::forward<M>(m), self.fmap_err);
+      if (cpo::validate(m)) {
+        return monas<result_t>(self.fmap(cpo::unwrap(std::forward<M>(m))));
+      } else {
+        // 無効値の変換処理
+        if constexpr (is_ptr_to_opt_v<std::remove_cvref_t<traits::unwrap_other_t<M>>, result_t>) {
+          // nullptr -> nulloptへの無効値の変換（利便性のための特殊対応）
+          return monas<result_t>(std::nullopt);
+        } else {
+          static_assert(std::constructible_from<result_t, traits::unwrap_other_t<M>>, "Cannot convert left value type");
+          // その他デフォルト、そのまま構築を試みる
+          return monas<result_t>(cpo::unwrap_other(std::forward<M>(m)));
+        }
+      }
     }
-
+    
     template<either M>
-      requires std::same_as<nil, Ferr> and
-               std::invocable<Fok, traits::unwrap_t<M>> and
-               std::invocable<Fok, traits::unwrap_other_t<M>> and
-               std::common_with<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Fok, traits::unwrap_other_t<M>>>
-    friend constexpr auto operator|(M&& m, match_impl self) {
-      using result_t = std::common_type_t<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Fok, traits::unwrap_other_t<M>>>;
-
-      return self.invoke_impl<result_t>(std::forward<M>(m), self.fmap_ok);
+      requires detail::not_map_reusable<F&, M> and
+               not_void_resulted<F, traits::unwrap_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_impl self) {
+      // 有効値の型
+      using R = std::remove_cvref_t<std::invoke_result_t<F, traits::unwrap_t<M>>>;
+      // 無効値の型
+      using L = std::remove_cvref_t<traits::unwrap_other_t<M>>;
+      
+      if (cpo::validate(m)) {
+        return monas<sachet<L, R>>(std::in_place, std::in_place_index<1>, self.fmap(cpo::unwrap(std::forward<M>(m))));
+      } else {
+        return monas<sachet<L, R>>(std::in_place, std::in_place_index<0>, cpo::unwrap_other(std::forward<M>(m)));
+      }
     }
   };
 
-  template<typename Fok, typename Ferr>
-  match_impl(Fok&&, Ferr&&) -> match_impl<Fok, Ferr>;
+  template<typename F>
+  map_impl(F&&) -> map_impl<F>;
 
 } // namespace harmony::detail
 
 namespace harmony::inline monadic_op {
 
   /**
-  * @brief Eitherモナドな型の有効値と無効値をmapする
-  * @brief M<T, E>のような型の有効値と無効値をそれぞれ共通の型Rに変換する
-  * @param fok T -> R へmapするCallableオブジェクト
-  * @param fee E -> R へmapするCallableオブジェクト（省略された場合、どちらに対してもfokによるmapを試みる）
-  * @return Rがunwrappableならばmonas<R>、それ以外の場合はRのオブジェクト、R = voidならば戻り値はない
+  * @brief モナド的な型に対してmapを適用する（有効値を任意の型の値へ写す）
+  * @brief M<T, E>のような型をM<U, E>のように変換する
+  * @param f T -> U へmapするCallableオブジェクト
   */
-  inline constexpr auto match = []<typename Fok, typename Ferr = nil>(Fok&& fok, Ferr&& ferr = {}) noexcept(std::is_nothrow_move_constructible_v<Fok> and std::is_nothrow_move_constructible_v<Ferr>) -> detail::match_impl<Fok, Ferr> {
-    return detail::match_impl{ .fmap_ok = std::forward<Fok>(fok), .fmap_err = std::forward<Ferr>(ferr) };
+  inline constexpr auto map = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::map_impl<F> {
+    return detail::map_impl{ .fmap = std::forward<F>(f) };
   };
 
-  inline constexpr auto &fold = match;
+  inline constexpr auto& transform = map;
 
 } // namespace harmony::inline monadic_op
 
 namespace harmony::detail {
 
-  template<typename Pred>
-  struct exists_impl {
-    [[no_unique_address]] Pred f_pred;
+  /**
+  * @brief 範囲の範囲を連結するview、flat_mapの結果になる
+  * @details std::ranges::join_viewとは異なり、要素を消費せずにconstのまま空かどうかを判定できる（Wの要素となる範囲を先頭から作り直して確かめる）。
+  * そのため、全ての範囲が空ならvalidateで無効となる。走査中の範囲はview自身が保持するので、入力範囲として1度だけ走査する
+  * @tparam W 範囲を要素とするview
+  */
+  template<std::ranges::view W>
+    requires std::ranges::input_range<W> and
+             std::ranges::viewable_range<std::ranges::range_reference_t<W>>
+  class flat_map_view : public std::ranges::view_interface<flat_map_view<W>> {
+    using inner_t = std::views::all_t<std::ranges::range_reference_t<W>>;
 
-    template<maybe M>
-      requires std::predicate<Pred, traits::unwrap_t<M>>
-    friend constexpr bool operator|(M&& m, exists_impl self) noexcept(noexcept(cpo::validate(m)) and noexcept(self.f_pred(cpo::unwrap(m)))) {
-      if (cpo::validate(m)) {
-        return self.f_pred(cpo::unwrap(m));
+    W m_base;
+    // 走査中の範囲、Wの要素が値であればここで所有する（コピーでは引き継がない）
+    std::optional<inner_t> m_inner;
+
+    class iterator {
+      flat_map_view* m_parent = nullptr;
+      std::ranges::iterator_t<W> m_outer{};
+      std::ranges::iterator_t<inner_t> m_it{};
+
+      /**
+      * @brief 空でない範囲が見つかるまで外側を進める
+      */
+      constexpr void satisfy() {
+        for (; m_outer != std::ranges::end(m_parent->m_base); ++m_outer) {
+          auto& inner = m_parent->m_inner.emplace(std::views::all(*m_outer));
+          m_it = std::ranges::begin(inner);
+          if (m_it != std::ranges::end(inner)) {
+            return;
+          }
+        }
       }
-      return false;
-    }
 
-    template<list M>
-      requires std::predicate<Pred, std::ranges::range_reference_t<M>>
-    friend constexpr bool operator|(M&& m, exists_impl self) noexcept(noexcept(std::is_nothrow_invocable_r_v<bool, Pred, std::ranges::range_reference_t<M>>)) {
-      auto it = std::ranges::begin(m);
-      const auto fin = std::ranges::end(m);
+    public:
+      using iterator_concept = std::input_iterator_tag;
+      using value_type = std::ranges::range_value_t<inner_t>;
+      using difference_type = std::common_type_t<std::ranges::range_difference_t<W>, std::ranges::range_difference_t<inner_t>>;
 
-      for (; it != fin; ++it) {
-        if (self.f_pred(*it)) return true;
+      iterator() = default;
+
+      constexpr explicit iterator(flat_map_view& parent)
+        : m_parent(&parent)
+        , m_outer(std::ranges::begin(parent.m_base))
+      {
+        satisfy();
       }
 
-      return false;
-    }
-  };
+      constexpr auto operator*() const -> std::ranges::range_reference_t<inner_t> {
+        return *m_it;
+      }
 
-  template<typename F>
-  exists_impl(F&&) -> exists_impl<F>;
-}
+      constexpr auto operator++() -> iterator& {
+        if (++m_it == std::ranges::end(*m_parent->m_inner)) {
+          ++m_outer;
+          satisfy();
+        }
+        return *this;
+      }
 
-namespace harmony::inline monadic_op {
+      constexpr void operator++(int) {
+        ++*this;
+      }
 
-  /**
-  * @brief maybeモナドな型の有効値が指定された条件を満たすかをチェックする
-  * @param f 有効値に対する述語オブジェクト
-  * @return 無効値を保持していた場合はfalse、そうでなければfを適用した結果のbool値
-  */
-  inline constexpr auto exists = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::exists_impl<F> {
-    return detail::exists_impl{ .f_pred = std::forward<F>(f) };
-  };
+      constexpr bool operator==(std::default_sentinel_t) const {
+        return m_outer == std::ranges::end(m_parent->m_base);
+      }
+    };
 
-}
+  public:
 
-namespace harmony::inline monadic_op {
+    constexpr explicit flat_map_view(W base)
+      : m_base(std::move(base))
+    {}
 
-  /**
-  * @brief 受け取った関数を呼び出し、その結果か例外ポインタのどちらかを保持したeitherを返す
-  * @param f 例外を投げうるCallableオブジェクト
-  * @param args fの引数
-  * @return f(args...)の戻り値型をRとすると、Either<std::exception_ptr, R>のようなオブジェクト
-  */
-  inline constexpr  auto try_catch = []<typename F, typename... Args>(F&& f, Args&&... args) noexcept -> monas<sachet<std::exception_ptr, std::invoke_result_t<F, Args...>>> {
-    using R = std::invoke_result_t<F, Args...>;
-    using either_t = sachet<std::exception_ptr, R>;
-    using return_t = monas<either_t>;
+    constexpr flat_map_view(const flat_map_view& other) requires std::copy_constructible<W>
+      : m_base(other.m_base)
+    {}
 
-    try {
-      return return_t(std::in_place, std::variant<std::exception_ptr, R>(std::in_place_index<1>, std::invoke(std::forward<F>(f), std::forward<Args>(args)...)));
-    } catch(...) {
-      return return_t(std::in_place, std::variant<std::exception_ptr, R>(std::in_place_index<0>, std::current_exception()));
-    }
-  };
+    constexpr flat_map_view(flat_map_view&&) = default;
 
-}
+    constexpr auto operator=(const flat_map_view& other) -> flat_map_view& requires std::copyable<W> {
+      m_base = other.m_base;
+      m_inner.reset();
+      return *this;
+    }
 
-namespace harmony::detail {
+    constexpr auto operator=(flat_map_view&&) -> flat_map_view& = default;
 
-  template<bool C>
-  concept not_fold = (not C);
+    constexpr auto base() const & -> W requires std::copy_constructible<W> {
+      return m_base;
+    }
 
-  template<typename T, bool IsFold = false>
-  struct map_to_impl {
+    constexpr auto base() && -> W {
+      return std::move(m_base);
+    }
 
-    template<unwrappable M>
-      requires not_fold<IsFold> and without_narrowing_convertible<traits::unwrap_t<M>, T>
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, map_to_impl) noexcept(noexcept(T(*std::move(m)))) -> T {
-      return T(std::move(*m));
+    constexpr auto begin() -> iterator {
+      return iterator(*this);
     }
 
-    template<maybe M>
-      requires not_fold<IsFold> and without_narrowing_convertible<traits::unwrap_t<M>, T> and
-               std::default_initializable<T> 
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, map_to_impl) noexcept(noexcept(T(*std::move(m))) and std::is_nothrow_default_constructible_v<T>) -> T {
-      if (m) {
-        return T(std::move(*m));
-      } else {
-        return T{};
-      }
+    constexpr auto end() const noexcept -> std::default_sentinel_t {
+      return std::default_sentinel;
     }
 
-    template<either M>
-      requires IsFold and
-               without_narrowing_convertible<traits::unwrap_t<M>, T> and
-               without_narrowing_convertible<traits::unwrap_other_t<M>, T>
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, map_to_impl) noexcept(noexcept(T(*std::move(m))) and noexcept(T(std::move(m.unwrap_err())))) -> T {
-      if (m) {
-        return T(std::move(*m));
-      } else {
-        return T(std::move(m.unwrap_err()));
+    /**
+    * @brief 連結した結果が空かどうかを、要素を消費せずに判定する
+    * @details 要素の範囲が参照で得られる入力範囲の場合、調べると消費してしまうので判定できない（maybeにならない）
+    */
+    constexpr bool empty() const
+      requires std::ranges::input_range<const W> and
+               (std::ranges::forward_range<std::ranges::range_reference_t<const W>> or
+                not std::is_reference_v<std::ranges::range_reference_t<const W>>)
+    {
+      for (auto&& elem : m_base) {
+        auto inner = std::views::all(std::forward<decltype(elem)>(elem));
+        if (std::ranges::begin(inner) != std::ranges::end(inner)) {
+          return false;
+        }
       }
+      return true;
     }
   };
-}
-
-namespace harmony::inline monadic_op {
 
-  /**
-  * @brief 有効値を取り出して変換する、有効値を保持しているかのチェックを行わない
-  * @details 縮小変換は禁止
-  * @tparam T 変換先の型
-  */
-  template<typename T>
-    requires (not std::is_reference_v<T>)
-  inline constexpr detail::map_to_impl<T> map_to;
+  template<typename W>
+  flat_map_view(W&&) -> flat_map_view<std::views::all_t<W>>;
 
   /**
-  * @brief 有効値及び無効値を取り出して同じ型に変換する
-  * @brief maybeな型が無効値を持つ場合、Tをデフォルト構築して返す
-  * @details 縮小変換は禁止
-  * @tparam T 変換先の型
+  * @brief flat_map_viewの連結する各範囲に、要素毎の変換を掛ける（flat_mapの後のmap_each）
   */
-  template<typename T>
-    requires (not std::is_reference_v<T>)
-  inline constexpr detail::map_to_impl<T, true> fold_to;
+  template<typename F>
+  struct each_transform {
+    [[no_unique_address]] F fmap;
+
+    template<std::ranges::viewable_range R>
+    constexpr auto operator()(R&& r) const {
+      return std::views::transform(std::forward<R>(r), fmap);
+    }
+  };
+
+  template<typename F>
+  struct map_each_impl {
+
+    [[no_unique_address]] F fmap;
+
+    template<list M>
+      requires (not specialization_of<std::remove_cvref_t<M>, monas>) and
+               std::ranges::viewable_range<M> and
+               std::regular_invocable<F&, std::ranges::range_reference_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_each_impl self) {
+      return monas(std::views::transform(std::forward<M>(m), std::move(self.fmap)));
+    }
+
+    /**
+    * @details monasが所有する範囲はtransform_viewに移動し、参照している範囲は参照する
+    */
+    template<list T>
+      requires std::ranges::viewable_range<T> and
+               std::regular_invocable<F&, std::ranges::range_reference_t<T>>
+    friend constexpr specialization_of<monas> auto operator|(monas<T>&& m, map_each_impl self) {
+      return monas(std::views::transform(static_cast<T&&>(std::move(m)), std::move(self.fmap)));
+    }
+
+    /**
+    * @details flat_mapの結果は連結する各範囲の側で変換し、結果もflat_map_viewのままにする（空かどうかを判定できるようにする）
+    */
+    template<typename W>
+      requires std::regular_invocable<F&, std::ranges::range_reference_t<flat_map_view<W>>>
+    friend constexpr specialization_of<monas> auto operator|(monas<flat_map_view<W>>&& m, map_each_impl self) {
+      using fmap_t = std::decay_t<F>;
+      return monas(flat_map_view(std::views::transform(static_cast<flat_map_view<W>&&>(std::move(m)).base(), each_transform<fmap_t>{ .fmap = fmap_t(std::move(self.fmap)) })));
+    }
+  };
+
+  template<typename F>
+  map_each_impl(F&&) -> map_each_impl<F>;
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief listモナドの各要素を変換する、変換は遅延され中間のコンテナは作られない
+  * @details 結果はstd::ranges::transform_viewを保持するmonasとなり、map_to<Container>によって実体化する
+  * @param f 要素型 -> U へ変換するCallableオブジェクト
+  */
+  inline constexpr auto map_each = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::map_each_impl<std::remove_cvref_t<F>> {
+    return detail::map_each_impl<std::remove_cvref_t<F>>{ .fmap = std::forward<F>(f) };
+  };
 
 } // namespace harmony::inline monadic_op
 
 namespace harmony::detail {
 
-  template<typename U>
-  struct value_or_impl {
-    // コピーorムーブして保持
-    U tmp_hold;
+  /**
+  * @brief 要素を受けて範囲を返すCallable
+  */
+  template<typename F, typename R>
+  concept range_resulted =
+    std::regular_invocable<F&, std::ranges::range_reference_t<R>> and
+    std::ranges::input_range<std::invoke_result_t<F&, std::ranges::range_reference_t<R>>>;
 
-    template<maybe M>
-      requires std::convertible_to<U, std::remove_cvref_t<traits::unwrap_t<M>>> and
-               detail::value_or_reusable<U, M>
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, value_or_impl&& self) noexcept(noexcept(std::move(m).value_or(std::forward<U>(self.tmp_hold)))) {
-      return std::move(m).value_or(std::move(self.tmp_hold));
-    }
+  template<typename F, typename R>
+  using flat_map_value_t = std::ranges::range_value_t<std::invoke_result_t<F&, std::ranges::range_reference_t<R>>>;
 
-    template<maybe M>
-      requires std::convertible_to<U, std::remove_cvref_t<traits::unwrap_t<M>>>
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, value_or_impl&& self) noexcept(noexcept(cpo::validate(m)) and noexcept(cpo::unwrap(m)) and std::is_nothrow_constructible_v<std::remove_cvref_t<traits::unwrap_t<M>>, U>) {
-      using R = std::remove_cvref_t<traits::unwrap_t<M>>;
+  /**
+  * @brief flat_map_viewの連結する各範囲を、さらにflat_mapする（flat_mapの後のflat_map）
+  */
+  template<typename F>
+  struct each_flat_map {
+    [[no_unique_address]] F fmap;
 
-      if (cpo::validate(m)) {
-        return cpo::unwrap(std::move(m));
-      } else {
-        return R(std::move(self.tmp_hold));
-      }
+    template<std::ranges::viewable_range R>
+    constexpr auto operator()(R&& r) const {
+      return flat_map_view(std::views::transform(std::forward<R>(r), fmap));
     }
   };
 
-  template<typename U>
-  value_or_impl(U&&) -> value_or_impl<std::remove_cvref_t<U>>;
+  /**
+  * @brief 各要素から得た範囲を遅延して連結する
+  */
+  template<typename F>
+  struct flat_map_impl {
 
+    [[no_unique_address]] F fmap;
 
-  template<typename... Args>
-  struct value_or_construct_impl {
-    // チェーンの中でのみ使用されることを想定しているので、ダングリング参照にはならないものとする
-    std::tuple<Args&&...> tmp_hold;
+    template<list M>
+      requires (not specialization_of<std::remove_cvref_t<M>, monas>) and
+               std::ranges::viewable_range<M> and
+               range_resulted<F, M>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, flat_map_impl self) {
+      return monas(flat_map_view(std::views::transform(std::forward<M>(m), std::move(self.fmap))));
+    }
 
-    template<maybe M>
-      requires std::constructible_from<std::remove_cvref_t<traits::unwrap_t<M>>, Args&&...>
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, value_or_construct_impl&& self) noexcept(noexcept(cpo::validate(m)) and noexcept(cpo::unwrap(std::move(m))) and std::is_nothrow_constructible_v<std::remove_cvref_t<traits::unwrap_t<M>>, Args&&...>) -> std::remove_cvref_t<traits::unwrap_t<M>> {
-      using R = std::remove_cvref_t<traits::unwrap_t<M>>;
+    template<list T>
+      requires std::ranges::viewable_range<T> and
+               range_resulted<F, T>
+    friend constexpr specialization_of<monas> auto operator|(monas<T>&& m, flat_map_impl self) {
+      return monas(flat_map_view(std::views::transform(static_cast<T&&>(std::move(m)), std::move(self.fmap))));
+    }
 
-      if (cpo::validate(m)) {
-        return cpo::unwrap(std::move(m));
-      } else {
-        return std::make_from_tuple<R>(std::move(self.tmp_hold));
-      }
+    /**
+    * @details flat_mapの結果は連結する各範囲の側でflat_mapし、入れ子にしない（空かどうかを判定できるようにする）
+    */
+    template<typename W>
+      requires range_resulted<F, flat_map_view<W>>
+    friend constexpr specialization_of<monas> auto operator|(monas<flat_map_view<W>>&& m, flat_map_impl self) {
+      using fmap_t = std::decay_t<F>;
+      return monas(flat_map_view(std::views::transform(static_cast<flat_map_view<W>&&>(std::move(m)).base(), each_flat_map<fmap_t>{ .fmap = fmap_t(std::move(self.fmap)) })));
     }
   };
 
+  /**
+  * @brief 各要素から得た範囲を連結して、memory_resourceから確保したstd::pmr::vectorに詰める
+  */
+  template<typename F>
+  struct pmr_flat_map_impl {
 
-  template<std::invocable F>
-  struct value_or_else_impl {
-    F tmp_f;
+    [[no_unique_address]] F fmap;
+    std::pmr::memory_resource* resource;
 
-    template<maybe M>
-      requires std::convertible_to<std::remove_cvref_t<traits::unwrap_t<M>>, std::invoke_result_t<F>>
-    [[nodiscard]]
-    friend constexpr auto operator|(monas<M>&& m, value_or_else_impl&& self) noexcept(noexcept(cpo::validate(m)) and noexcept(cpo::unwrap(std::move(m))) and std::is_nothrow_invocable_r_v<std::remove_cvref_t<traits::unwrap_t<M>>, std::invoke_result_t<F>>) -> std::remove_cvref_t<traits::unwrap_t<M>> {
-      if (cpo::validate(m)) {
-        return cpo::unwrap(std::move(m));
-      } else {
-        return std::move(self.tmp_f)();
+    template<typename R>
+    auto collect(R&& r) -> std::pmr::vector<flat_map_value_t<F, R>> {
+      std::pmr::vector<flat_map_value_t<F, R>> result(resource);
+
+      // 1要素から少なくとも1つは出力されると見込んで予約しておく
+      if constexpr (std::ranges::sized_range<R>) {
+        result.reserve(std::ranges::size(r));
+      }
+
+      for (auto&& v : r) {
+        for (auto&& elem : std::invoke(fmap, std::forward<decltype(v)>(v))) {
+          result.emplace_back(std::forward<decltype(elem)>(elem));
+        }
       }
+
+      return result;
+    }
+
+    template<list M>
+      requires (not specialization_of<std::remove_cvref_t<M>, monas>) and
+               range_resulted<F, M>
+    friend auto operator|(M&& m, pmr_flat_map_impl self) -> monas<std::pmr::vector<flat_map_value_t<F, M>>> {
+      return monas(self.collect(m));
+    }
+
+    template<list T>
+      requires range_resulted<F, T>
+    friend auto operator|(monas<T>&& m, pmr_flat_map_impl self) -> monas<std::pmr::vector<flat_map_value_t<F, T>>> {
+      T& r = m;
+      return monas(self.collect(r));
     }
   };
 
-  template<typename F>
-  value_or_else_impl(F&&) -> value_or_else_impl<F>;
+  struct flat_map_fn {
 
-} // namespace detail
+    template<typename F>
+    constexpr auto operator()(F&& f) const noexcept(std::is_nothrow_constructible_v<std::remove_cvref_t<F>, F>) -> flat_map_impl<std::remove_cvref_t<F>> {
+      return { .fmap = std::forward<F>(f) };
+    }
+
+    template<typename F>
+    auto operator()(F&& f, std::pmr::memory_resource* resource) const noexcept(std::is_nothrow_constructible_v<std::remove_cvref_t<F>, F>) -> pmr_flat_map_impl<std::remove_cvref_t<F>> {
+      return { .fmap = std::forward<F>(f), .resource = resource };
+    }
+  };
+
+} // namespace harmony::detail
 
 namespace harmony::inline monadic_op {
 
   /**
-  * @brief 有効値を保持していなければ指定された値を返す
+  * @brief listモナドのbind、各要素から0個以上の要素を持つ範囲を作り、それらを連結する
+  * @details flat_map(f)は結果をflat_map_viewで遅延して連結し、全ての範囲が空であれば無効値となる。
+  * flat_map(f, resource)は結果をその場で連結し、resourceから領域を確保したstd::pmr::vectorに詰める
+  * @param f 要素型 -> 範囲 へ変換するCallableオブジェクト
   */
-  inline constexpr auto value_or = []<typename T>(T&& v) {
-    return detail::value_or_impl{ .tmp_hold = std::forward<T>(v) };
-  };
+  inline constexpr detail::flat_map_fn flat_map{};
+
+} // namespace harmony::inline monadic_op
+
+namespace harmony::detail {
 
   /**
-  * @brief 有効値を保持していなければ指定された値から構築して返す
+  * @brief maybe/eitherな型ごとに、有効値・無効値からの構築方法を定める
+  * @details コルーチンの戻り値やcollectの結果の構築に使用する
   */
-  inline constexpr auto value_or_construct = []<typename... Args>(Args&&... args) {
-    return detail::value_or_construct_impl<Args...>{ .tmp_hold = std::forward_as_tuple(std::forward<Args>(args)...) };
+  template<typename R>
+  struct result_builder;
+
+  template<typename T>
+  struct result_builder<std::optional<T>> {
+
+    template<typename U>
+      requires std::constructible_from<std::optional<T>, U>
+    static constexpr auto valid(U&& v) -> std::optional<T> {
+      return std::optional<T>(std::forward<U>(v));
+    }
+
+    template<maybe M>
+    static constexpr auto invalid(M&&) noexcept -> std::optional<T> {
+      return std::nullopt;
+    }
+  };
+
+  template<typename L, typename R>
+  struct result_builder<sachet<L, R>> {
+
+    template<typename U>
+      requires std::same_as<std::remove_cvref_t<U>, sachet<L, R>> or std::constructible_from<R, U>
+    static constexpr auto valid(U&& v) -> sachet<L, R> {
+      if constexpr (std::same_as<std::remove_cvref_t<U>, sachet<L, R>>) {
+        return std::forward<U>(v);
+      } else {
+        return sachet<L, R>(std::in_place_index<1>, std::forward<U>(v));
+      }
+    }
+
+    /**
+    * @brief 無効値がエラー値としてLに変換できる
+    * @details nullptrやnulloptは値を持たないことを表すだけなので除外する
+    */
+    template<typename M>
+    static constexpr bool error_propagatable =
+      either<M> and
+      not std::same_as<std::remove_cvref_t<traits::unwrap_other_t<M>>, std::nullptr_t> and
+      not std::same_as<std::remove_cvref_t<traits::unwrap_other_t<M>>, std::nullopt_t> and
+      std::constructible_from<L, traits::unwrap_other_t<M>>;
+
+    /**
+    * @details 無効値はunwrap_other()の結果から構築する、それができない場合はLをデフォルト構築する
+    */
+    template<maybe M>
+      requires error_propagatable<M> or std::default_initializable<L>
+    static constexpr auto invalid(M&& m) -> sachet<L, R> {
+      if constexpr (error_propagatable<M>) {
+        return sachet<L, R>(std::in_place_index<0>, cpo::unwrap_other(std::forward<M>(m)));
+      } else {
+        return sachet<L, R>(std::in_place_index<0>);
+      }
+    }
   };
 
   /**
-  * @brief 有効値を保持していなければ指定されたCallableの戻り値を返す
+  * @brief maybeな値を要素とする範囲
   */
-  inline constexpr auto value_or_else = []<typename F>(F&& f) {
-    return detail::value_or_else_impl{ .tmp_f = std::forward<F>(f) };
+  template<typename R>
+  concept range_of_maybe =
+    std::ranges::input_range<R> and
+    maybe<std::ranges::range_reference_t<R>>;
+
+  /**
+  * @brief collectの結果型、要素がエラー値を持つeitherならばsachet<E, C>、そうでなければstd::optional<C>
+  */
+  template<typename E, typename C>
+  struct collect_result {
+    using type = std::optional<C>;
   };
 
-} // namespace harmony::inline monadic_op
+  template<either E, typename C>
+    requires (not std::same_as<std::remove_cvref_t<traits::unwrap_other_t<E>>, std::nullptr_t>) and
+             (not std::same_as<std::remove_cvref_t<traits::unwrap_other_t<E>>, std::nullopt_t>)
+  struct collect_result<E, C> {
+    using type = sachet<std::remove_cvref_t<traits::unwrap_other_t<E>>, C>;
+  };
+
+  template<typename R, typename C>
+  using collect_result_t = typename collect_result<std::ranges::range_reference_t<R>, C>::type;
 
-namespace harmony {
-  
   /**
-  * @brief 有効値と無効値の関係を反転させるラッパークラス
-  * @details このクラスはeitherとなる
+  * @brief 範囲を所有している場合は要素をムーブする
   */
-  template<maybe T>
-  struct abekobe {
+  template<bool Move, typename E>
+  constexpr decltype(auto) forward_element(E&& e) noexcept {
+    if constexpr (Move) {
+      return std::move(e);
+    } else {
+      return std::forward<E>(e);
+    }
+  }
 
-    static_assert(not std::is_rvalue_reference_v<T>, "T must not be a rvalue reference type.");
+  template<typename C, typename R>
+  constexpr void reserve_for(C& c, R& r) {
+    if constexpr (std::ranges::sized_range<R> and requires(std::ranges::range_size_t<R> n) { c.reserve(n); }) {
+      c.reserve(std::ranges::size(r));
+    }
+  }
 
-    // lvalueから初期化された際、Tは左辺値参照となる
-    static constexpr bool has_reference = std::is_lvalue_reference_v<T>;
+  /**
+  * @brief 異なる要素への書き込みを複数スレッドから行えるコンテナ
+  * @details std::vector<bool>のように要素がプロキシ参照で、同じワードを共有するものは除外する
+  */
+  template<typename C>
+  concept element_wise_writable =
+    std::ranges::random_access_range<C> and
+    std::is_reference_v<std::ranges::range_reference_t<C>> and
+    requires(C& c, std::size_t n) { c.resize(n); };
 
-    // Tから参照を外した型、lvalueから初期化された時だけTと異なる
-    using M = std::remove_reference_t<T>;
+  /**
+  * @brief 先頭から順にチェックし、最初の無効値を返すか全ての有効値をCに詰めて返す
+  */
+  template<typename C, bool Move, typename R>
+  constexpr auto collect_serial(R& r) -> collect_result_t<R, C> {
+    using result_t = collect_result_t<R, C>;
 
-    T bound;
+    C out{};
+    reserve_for(out, r);
 
-    /**
-    * @brief 有効値を取得する
-    * @return Tの無効値を返す
-    */
-    [[nodiscard]]
-    constexpr decltype(auto) operator*() noexcept(noexcept(cpo::unwrap_other(bound))) requires either<M> {
-      return cpo::unwrap_other(bound);
+    for (auto&& elem : r) {
+      if (not cpo::validate(elem)) {
+        return result_builder<result_t>::invalid(forward_element<Move>(std::forward<decltype(elem)>(elem)));
+      }
+      out.insert(std::ranges::end(out), cpo::unwrap(forward_element<Move>(std::forward<decltype(elem)>(elem))));
     }
 
-    [[nodiscard]]
-    constexpr decltype(auto) operator*() && noexcept(noexcept(cpo::unwrap_other(std::move(bound)))) requires either<M> and (not has_reference) {
-      return cpo::unwrap_other(std::move(bound));
-    }
+    return result_builder<result_t>::valid(std::move(out));
+  }
 
-    /**
-    * @brief 有効値を取得する
-    * @brief Tがmaybeでしかない時は、無効値としてT自身を返す
-    */
-    [[nodiscard]]
-    constexpr auto operator*() noexcept -> T& {
-      return bound;
+  /**
+  * @brief 範囲を分割して並列にチェックし、無効値が見つかった位置より後ろを担当するワーカーは処理を打ち切る
+  * @details 結果はcollect_serial()と同じく、最も前にある無効値になる
+  */
+  template<typename C, bool Move, typename R>
+  auto collect_parallel(R& r, std::size_t grain, parallel_executor_ref exec) -> collect_result_t<R, C> {
+    using result_t = collect_result_t<R, C>;
+    using diff_t = std::ranges::range_difference_t<R>;
+
+    const std::size_t size = static_cast<std::size_t>(std::ranges::size(r));
+    const auto first = std::ranges::begin(r);
+
+    // 見つかった無効値の最小の位置、無ければsize
+    std::atomic<std::size_t> failure{size};
+
+    parallel_chunks(exec, size, grain, [&](std::size_t b, std::size_t e) {
+      for (std::size_t i = b; i < e; ++i) {
+        // より前で無効値が見つかっていれば、この範囲の結果は使われない
+        if ((i & 255) == 0 and failure.load(std::memory_order_relaxed) < b) return;
+
+        if (not cpo::validate(first[static_cast<diff_t>(i)])) {
+          std::size_t current = failure.load(std::memory_order_relaxed);
+          while (i < current and not failure.compare_exchange_weak(current, i, std::memory_order_relaxed)) {}
+          return;
+        }
+      }
+    });
+
+    if (const std::size_t pos = failure.load(); pos < size) {
+      return result_builder<result_t>::invalid(forward_element<Move>(first[static_cast<diff_t>(pos)]));
     }
 
-    [[nodiscard]]
-    constexpr auto operator*() && noexcept -> T&& requires (not has_reference) {
-      return std::move(bound);
+    C out{};
+
+    if constexpr (element_wise_writable<C> and requires(std::size_t n) { out[n] = cpo::unwrap(forward_element<Move>(first[0])); }) {
+      // ランダムアクセス可能なコンテナには、取り出しも並列に行う
+      out.resize(size);
+      parallel_chunks(exec, size, grain, [&](std::size_t b, std::size_t e) {
+        for (std::size_t i = b; i < e; ++i) {
+          out[i] = cpo::unwrap(forward_element<Move>(first[static_cast<diff_t>(i)]));
+        }
+      });
+    } else {
+      reserve_for(out, r);
+      for (std::size_t i = 0; i < size; ++i) {
+        out.insert(std::ranges::end(out), cpo::unwrap(forward_element<Move>(first[static_cast<diff_t>(i)])));
+      }
     }
 
-    /**
-    * @brief 有効値を保持しているかを判定する
-    * @return Tが有効値を保持していればfalse, そうでないならtrue
-    */
-    [[nodiscard]]
-    constexpr explicit operator bool() const noexcept {
-      return not cpo::validate(bound);
+    return result_builder<result_t>::valid(std::move(out));
+  }
+
+  template<typename C, typename R>
+  concept collectable_to =
+    range_of_maybe<R> and
+    std::default_initializable<C> and
+    requires(C& c, std::ranges::range_reference_t<R> elem) {
+      c.insert(std::ranges::end(c), cpo::unwrap(std::forward<std::ranges::range_reference_t<R>>(elem)));
+    };
+
+  template<typename C, bool Parallel = false>
+  struct collect_impl {
+    std::size_t grain = default_parallel_grain;
+    parallel_executor_ref exec{};
+
+    template<typename R>
+    constexpr auto run(R& r) const {
+      constexpr bool owned = not std::is_lvalue_reference_v<R> and not std::ranges::view<std::remove_cvref_t<R>>;
+
+      if constexpr (Parallel and std::ranges::random_access_range<R> and std::ranges::sized_range<R>) {
+        return monas(collect_parallel<C, owned>(r, grain, exec));
+      } else {
+        return monas(collect_serial<C, owned>(r));
+      }
     }
 
     /**
-    * @brief 無効値を取得する
-    * @return Tの有効値を返す
+    * @brief 1ワーカーあたりの最小要素数と、ワーカーを動かすexecutor（省略可能、参照で保持する）を指定する
     */
-    [[nodiscard]]
-    constexpr decltype(auto) unwrap_err() noexcept(noexcept(cpo::unwrap(bound))) {
-      return cpo::unwrap(bound);
+    template<executor... E>
+      requires Parallel and (sizeof...(E) <= 1)
+    constexpr auto operator()(std::size_t g, E&... e) const noexcept -> collect_impl {
+      return { .grain = g, .exec = parallel_executor_ref(e...) };
     }
 
-    [[nodiscard]]
-    constexpr decltype(auto) unwrap_err() && noexcept(noexcept(cpo::unwrap(std::move(bound)))) requires (not has_reference) {
-      return cpo::unwrap(std::move(bound));
+    template<typename R>
+      requires (not specialization_of<std::remove_cvref_t<R>, monas>) and
+               collectable_to<C, std::remove_reference_t<R>>
+    friend constexpr specialization_of<monas> auto operator|(R&& r, collect_impl self) {
+      return self.template run<R>(r);
     }
 
+    template<typename T>
+      requires collectable_to<C, std::remove_reference_t<T>>
+    friend constexpr specialization_of<monas> auto operator|(monas<T>&& m, collect_impl self) {
+      std::remove_reference_t<T>& r = m;
+      return self.template run<T>(r);
+    }
   };
 
-  template<maybe T>
-    requires std::is_lvalue_reference_v<T>
-  abekobe(T&) -> abekobe<T&>;
+} // namespace harmony::detail
 
-  template<maybe T>
-  abekobe(T&&) -> abekobe<std::remove_cv_t<T>>;
+namespace harmony::inline monadic_op {
 
   /**
-  * @brief 有効値と無効値を反転させる
-  * @return abekobe<M>をmonasでラップしたオブジェクト
+  * @brief maybeな値の範囲を、全ての有効値を詰めたコンテナのmaybeに変換する
+  * @details 先頭からチェックし、無効値が見つかった時点でその値を返す（eitherならばエラー値を保持するsachet<E, C>、そうでなければstd::optional<C>）。
+  * 範囲を所有している場合、値はムーブされる
+  * @tparam C 有効値を詰めるコンテナの型
   */
-  inline constexpr auto invert = []<maybe M>(M &&m) {
-    return monas<abekobe<M>>(std::in_place, std::forward<M>(m));
-  };
-}
+  template<typename C>
+  inline constexpr detail::collect_impl<C> collect{};
+
+  /**
+  * @brief collectを複数スレッドで行う、無効値が見つかった時点で他のスレッドの処理も打ち切られる
+  * @details ランダムアクセス可能かつサイズを求められる範囲の時にのみ並列化する。par_collect<C>(grain, exec)で1スレッドあたりの最小要素数と、ワーカーを動かすexecutor（省略した場合はプロセスで共有するthread_pool）を指定できる
+  * @tparam C 有効値を詰めるコンテナの型
+  */
+  template<typename C>
+  inline constexpr detail::collect_impl<C, true> par_collect{};
+
+} // namespace harmony::inline monadic_op
 
 namespace harmony {
-  namespace detail {
 
-    struct harmonize_impl {
+  /**
+  * @brief partition_resultsで振り分けた有効値・無効値の数
+  */
+  struct partition_count {
+    std::size_t valid;
+    std::size_t invalid;
+  };
 
-      /**
-      * @brief maybeでないような型のオブジェクトをeitherとして扱えるようにする
-      * @param value 変換する値
-      * @param check_invalid 無効値を判定する述語オブジェクト
-      * @return valueが無効値なら無効状態、そうでないなら有効状態を保持したeitherなオブジェクトをmonasでラップしたものを返す
-      */
-      template<typename T, std::predicate<T> P>
-        requires (not either<T>)
-      [[nodiscard]]
-      constexpr specialization_of<monas> auto operator()(T&& value, P&& check_invalid) const {
-        using RC = std::remove_cvref_t<T>;
-        using either_t = sachet<RC, RC>;
-        using return_t = monas<either_t>;
+} // namespace harmony
 
-        if (not check_invalid(value)) {
-          // 有効値として構築
-          return return_t(std::in_place, std::variant<RC, RC>(std::in_place_index<1>, std::forward<T>(value)));
-        } else {
-          // 無効値として構築
-          return return_t(std::in_place, std::variant<RC, RC>(std::in_place_index<0>, std::forward<T>(value)));
-        }
+namespace harmony::detail {
+
+  template<typename VC, typename EC, typename R>
+  concept partitionable_to =
+    std::ranges::input_range<R> and
+    either<std::ranges::range_reference_t<R>> and
+    requires(VC& vc, EC& ec, std::ranges::range_reference_t<R> elem) {
+      vc.insert(std::ranges::end(vc), cpo::unwrap(std::forward<std::ranges::range_reference_t<R>>(elem)));
+      ec.insert(std::ranges::end(ec), cpo::unwrap_other(std::forward<std::ranges::range_reference_t<R>>(elem)));
+    };
+
+  /**
+  * @brief 範囲を1度だけ走査して、有効値と無効値をそれぞれの出力先の末尾に追加する
+  */
+  template<bool Move, typename R, typename VC, typename EC>
+  constexpr auto partition_serial(R& r, VC& values, EC& errors) -> partition_count {
+    partition_count count{ values.size(), errors.size() };
+
+    for (auto&& elem : r) {
+      if (cpo::validate(elem)) {
+        values.insert(std::ranges::end(values), cpo::unwrap(forward_element<Move>(std::forward<decltype(elem)>(elem))));
+      } else {
+        errors.insert(std::ranges::end(errors), cpo::unwrap_other(forward_element<Move>(std::forward<decltype(elem)>(elem))));
       }
+    }
 
-      /**
-      * @brief maybeでないような型のオブジェクトをeitherとして扱えるようにする
-      * @param value 変換する値
-      * @param invalid 無効値として扱うTの値
-      * @return valueが無効値なら無効状態、そうでないなら有効状態を保持したeitherなオブジェクトをmonasでラップしたものを返す
-      */
-      template<typename T, std::equality_comparable_with<T> U = T>
-        requires (not either<T>)
-      [[nodiscard]]
-      constexpr specialization_of<monas> auto operator()(T&& value, U&& invalid) const {
-        return (*this)(std::forward<T>(value), [invalid_value = std::forward<U>(invalid)](const auto& comp_value) -> bool {
-          return invalid_value == comp_value; // 値が無効値である場合にtrueを返す
-        });
+    return { values.size() - count.valid, errors.size() - count.invalid };
+  }
+
+  /**
+  * @brief 範囲をチャンクに分割して、チャンクごとのバッファに並列に振り分けてから出力先に連結する
+  * @details 各ワーカーは自分のバッファと出力先の自分の区間にだけ書き込むため、ロックは必要ない
+  */
+  template<bool Move, typename R, typename VC, typename EC>
+  auto partition_parallel(R& r, VC& values, EC& errors, std::size_t grain, parallel_executor_ref exec) -> partition_count {
+    using diff_t = std::ranges::range_difference_t<R>;
+    using value_t = std::ranges::range_value_t<VC>;
+    using error_t = std::ranges::range_value_t<EC>;
+
+    const std::size_t size = static_cast<std::size_t>(std::ranges::size(r));
+    const std::size_t chunks = std::max<std::size_t>(1, std::min(hardware_workers(), size / (grain == 0 ? 1 : grain)));
+    const auto first = std::ranges::begin(r);
+
+    struct buffer {
+      std::vector<value_t> values;
+      std::vector<error_t> errors;
+    };
+    std::vector<buffer> buffers(chunks);
+
+    parallel_chunks(exec, chunks, 1, [&](std::size_t cb, std::size_t ce) {
+      for (std::size_t c = cb; c < ce; ++c) {
+        const std::size_t b = size * c / chunks;
+        const std::size_t e = size * (c + 1) / chunks;
+        auto part = std::ranges::subrange(first + static_cast<diff_t>(b), first + static_cast<diff_t>(e));
+        partition_serial<Move>(part, buffers[c].values, buffers[c].errors);
       }
+    });
 
-      /**
-      * @brief boolをeitherとして扱えるようにする
-      * @param value 変換するbool値
-      * @return either<bool, bool>、valueがfalseなら無効状態、trueなら有効状態となるeitherなオブジェクトをmonasでラップしたものを返す
-      */
-      [[nodiscard]]
-      constexpr specialization_of<monas> auto operator()(bool value) const {
-        return (*this)(value, false);
+    // 各チャンクの結果を書き込む位置を求める
+    std::vector<partition_count> offsets(chunks);
+    partition_count total{ values.size(), errors.size() };
+    for (std::size_t c = 0; c < chunks; ++c) {
+      offsets[c] = total;
+      total.valid += buffers[c].values.size();
+      total.invalid += buffers[c].errors.size();
+    }
+
+    if constexpr (element_wise_writable<VC> and element_wise_writable<EC>) {
+      values.resize(total.valid);
+      errors.resize(total.invalid);
+
+      parallel_chunks(exec, chunks, 1, [&](std::size_t cb, std::size_t ce) {
+        for (std::size_t c = cb; c < ce; ++c) {
+          std::ranges::move(buffers[c].values, std::ranges::begin(values) + static_cast<std::ranges::range_difference_t<VC>>(offsets[c].valid));
+          std::ranges::move(buffers[c].errors, std::ranges::begin(errors) + static_cast<std::ranges::range_difference_t<EC>>(offsets[c].invalid));
+        }
+      });
+    } else {
+      for (auto& buf : buffers) {
+        for (auto&& v : buf.values) values.insert(std::ranges::end(values), std::move(v));
+        for (auto&& e : buf.errors) errors.insert(std::ranges::end(errors), std::move(e));
       }
+    }
 
-      /**
-      * @brief 浮動小数点数型をeitherとして扱えるようにする
-      * @param value 変換する浮動小数値
-      * @return either<FP, FP>、valueがNaNなら無効状態、そうでないなら有効状態となるeitherなオブジェクトをmonasでラップしたものを返す
-      */
-      template<std::floating_point FP>
-      [[nodiscard]]
-      constexpr specialization_of<monas> auto operator()(FP value) const {
-        return (*this)(value, [](FP f) { return std::isnan(f); });
+    return { total.valid - offsets[0].valid, total.invalid - offsets[0].invalid };
+  }
+
+  template<typename VC, typename EC, bool Parallel = false>
+  struct partition_results_impl {
+    VC* values;
+    EC* errors;
+    std::size_t grain = default_parallel_grain;
+    parallel_executor_ref exec{};
+
+    template<typename R>
+    auto run(R& r) const -> partition_count {
+      constexpr bool owned = not std::is_lvalue_reference_v<R> and not std::ranges::view<std::remove_cvref_t<R>>;
+
+      if constexpr (Parallel and
+                    std::ranges::random_access_range<R> and std::ranges::sized_range<R> and
+                    std::default_initializable<std::ranges::range_value_t<VC>> and
+                    std::default_initializable<std::ranges::range_value_t<EC>>) {
+        return partition_parallel<owned>(r, *values, *errors, grain, exec);
+      } else {
+        return partition_serial<owned>(r, *values, *errors);
       }
+    }
 
-    };
-  } // namespace detail
+    template<typename R>
+      requires (not specialization_of<std::remove_cvref_t<R>, monas>) and
+               partitionable_to<VC, EC, std::remove_reference_t<R>>
+    friend auto operator|(R&& r, partition_results_impl self) -> partition_count {
+      return self.template run<R>(r);
+    }
+
+    template<typename T>
+      requires partitionable_to<VC, EC, std::remove_reference_t<T>>
+    friend auto operator|(monas<T>&& m, partition_results_impl self) -> partition_count {
+      std::remove_reference_t<T>& r = m;
+      return self.template run<T>(r);
+    }
+  };
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
 
   /**
-  * @brief maybeでないような型のオブジェクトをeitherとして扱えるようにする
-  * @details 返されるオブジェクトには渡されたvalueを完全転送する（適切にコピー/ムーブし、参照のままにしない）
+  * @brief eitherな値の範囲を1度だけ走査し、有効値と無効値をそれぞれのコンテナの末尾に追加する
+  * @details 出力先は事前に領域を予約しておくことを想定している。範囲を所有している場合、値はムーブされる
+  * @param values 有効値の出力先
+  * @param errors 無効値の出力先
+  * @return 追加した有効値と無効値の数
   */
-  inline constexpr detail::harmonize_impl harmonize{};
+  inline constexpr auto partition_results = []<typename VC, typename EC>(VC& values, EC& errors) noexcept -> detail::partition_results_impl<VC, EC> {
+    return { .values = std::addressof(values), .errors = std::addressof(errors) };
+  };
 
-  inline constexpr auto& to_either = harmonize;
+  /**
+  * @brief partition_resultsを複数スレッドで行う
+  * @details ランダムアクセス可能かつサイズを求められる範囲の時にのみ並列化する。
+  * 各スレッドはチャンクごとのバッファに振り分け、その後でバッファを出力先の各チャンクの位置にムーブする
+  * @param grain 1スレッドが担当する最小要素数
+  * @param exec ワーカーを動かすexecutor（省略可能）、参照で保持する。省略した場合はプロセスで共有するthread_poolを使用する
+  */
+  inline constexpr auto par_partition_results = []<typename VC, typename EC, executor... E>(VC& values, EC& errors, std::size_t grain = detail::default_parallel_grain, E&... exec) noexcept -> detail::partition_results_impl<VC, EC, true>
+    requires (sizeof...(E) <= 1)
+  {
+    return { .values = std::addressof(values), .errors = std::addressof(errors), .grain = grain, .exec = detail::parallel_executor_ref(exec...) };
+  };
 
-} // namespace harmony
+} // namespace harmony::inline monadic_op
+
+namespace harmony::detail {
+
+  /**
+  * @brief 添え字でコンテナの要素を指すプロキシを返すランダムアクセスイテレータ
+  * @details 要素はプロキシでしか表せないため、value_typeもプロキシとする
+  * @tparam V コンテナ型（constを含む）
+  * @tparam Proxy V*と添え字から構築できるプロキシ型
+  */
+  template<typename V, typename Proxy>
+  class proxy_iterator {
+    V* m_vec = nullptr;
+    std::ptrdiff_t m_index = 0;
+
+  public:
+    using iterator_concept = std::random_access_iterator_tag;
+    using iterator_category = std::input_iterator_tag;
+    using value_type = Proxy;
+    using difference_type = std::ptrdiff_t;
 
+    proxy_iterator() = default;
+
+    constexpr proxy_iterator(V* vec, std::ptrdiff_t index) noexcept
+      : m_vec(vec)
+      , m_index(index)
+    {}
+
+    constexpr auto operator*() const noexcept -> Proxy {
+      return { m_vec, static_cast<std::size_t>(m_index) };
+    }
+
+    constexpr auto operator[](difference_type n) const noexcept -> Proxy {
+      return { m_vec, static_cast<std::size_t>(m_index + n) };
+    }
+
+    constexpr auto operator++() noexcept -> proxy_iterator& { ++m_index; return *this; }
+    constexpr auto operator++(int) noexcept -> proxy_iterator { auto tmp = *this; ++m_index; return tmp; }
+    constexpr auto operator--() noexcept -> proxy_iterator& { --m_index; return *this; }
+    constexpr auto operator--(int) noexcept -> proxy_iterator { auto tmp = *this; --m_index; return tmp; }
+    constexpr auto operator+=(difference_type n) noexcept -> proxy_iterator& { m_index += n; return *this; }
+    constexpr auto operator-=(difference_type n) noexcept -> proxy_iterator& { m_index -= n; return *this; }
+
+    friend constexpr auto operator+(proxy_iterator it, difference_type n) noexcept -> proxy_iterator { return it += n; }
+    friend constexpr auto operator+(difference_type n, proxy_iterator it) noexcept -> proxy_iterator { return it += n; }
+    friend constexpr auto operator-(proxy_iterator it, difference_type n) noexcept -> proxy_iterator { return it -= n; }
+    friend constexpr auto operator-(const proxy_iterator& lhs, const proxy_iterator& rhs) noexcept -> difference_type { return lhs.m_index - rhs.m_index; }
+
+    friend constexpr bool operator==(const proxy_iterator& lhs, const proxy_iterator& rhs) noexcept { return lhs.m_index == rhs.m_index; }
+    friend constexpr auto operator<=>(const proxy_iterator& lhs, const proxy_iterator& rhs) noexcept { return lhs.m_index <=> rhs.m_index; }
+  };
+
+} // namespace harmony::detail
 
 namespace harmony {
-  namespace detail {
 
-    template<typename T>
-    constexpr auto lvalue_as_const(T& t) -> std::add_const_t<T>& {
-      return std::as_const(t);
+  /**
+  * @brief either値の列を、有効性のビットマスクと有効値・無効値それぞれの密な配列で保持するコンテナ
+  * @details i番目の要素の値は、i番目より前の有効な要素の数（ビットマスクのpopcount）を添え字として各配列から引く。
+  * 要素の追加は末尾にのみ行え、追加後に有効・無効を変更することはできない。listモナドとして扱え、bindは有効値の配列にだけ適用される
+  * @tparam L 無効値の型
+  * @tparam R 有効値の型
+  */
+  template<typename L, typename R>
+  class either_vector {
+    static constexpr std::size_t word_bits = 64;
+
+    std::vector<std::uint64_t> m_bits;
+    // m_rank[w]はw番目のワードより前にある有効な要素の数
+    std::vector<std::size_t> m_rank;
+    std::vector<R> m_values;
+    std::vector<L> m_errors;
+    std::size_t m_size = 0;
+
+    constexpr auto rank(std::size_t i) const noexcept -> std::size_t {
+      const std::uint64_t mask = (std::uint64_t(1) << (i % word_bits)) - 1;
+      return m_rank[i / word_bits] + static_cast<std::size_t>(std::popcount(m_bits[i / word_bits] & mask));
     }
 
-    template<typename T>
-    constexpr auto lvalue_as_const(T&& t) -> T&& {
-      return std::forward<T>(t);
+    constexpr void push_bit(bool valid) {
+      if (m_size % word_bits == 0) {
+        m_bits.push_back(0);
+        m_rank.push_back(m_values.size() - std::size_t(valid));
+      }
+      if (valid) {
+        m_bits.back() |= std::uint64_t(1) << (m_size % word_bits);
+      }
+      ++m_size;
     }
 
-    template<typename T>
-    using lvalue_as_const_t = decltype(lvalue_as_const(std::declval<T>()));
+    /**
+    * @brief 要素への参照として振る舞うプロキシ、eitherとして扱える
+    */
+    template<bool Const>
+    class reference_proxy {
+      using vector_t = std::conditional_t<Const, const either_vector, either_vector>;
 
-    template<typename F>
-    struct inspect_impl {
-      F ins_f;
+      vector_t* m_vec;
+      std::size_t m_index;
 
-      template<unwrappable M>
-        requires std::invocable<F, lvalue_as_const_t<traits::unwrap_t<M>>> and
-                 std::same_as<std::invoke_result_t<F, lvalue_as_const_t<traits::unwrap_t<M>>>, void>
-      friend constexpr auto operator|(monas<M>&& m, inspect_impl&& self) -> monas<M>&& {
-        std::invoke(std::move(self.ins_f), lvalue_as_const(cpo::unwrap(m)));
-        return std::move(m);
+    public:
+
+      constexpr reference_proxy(vector_t* vec, std::size_t index) noexcept
+        : m_vec(vec)
+        , m_index(index)
+      {}
+
+      [[nodiscard]]
+      constexpr explicit operator bool() const noexcept {
+        return m_vec->valid(m_index);
       }
 
-      template<maybe M>
-        requires std::invocable<F, lvalue_as_const_t<traits::unwrap_t<M>>> and
-                 std::same_as<std::invoke_result_t<F, lvalue_as_const_t<traits::unwrap_t<M>>>, void>
-      friend constexpr auto operator|(monas<M>&& m, inspect_impl&& self) -> monas<M>&& {
-        if (cpo::validate(m)) {
-          std::invoke(std::move(self.ins_f), lvalue_as_const(cpo::unwrap(m)));
-        }
-        return std::move(m);
+      [[nodiscard]]
+      constexpr auto operator*() const noexcept -> std::conditional_t<Const, const R&, R&> {
+        return m_vec->m_values[m_vec->rank(m_index)];
+      }
+
+      [[nodiscard]]
+      constexpr auto unwrap_err() const noexcept -> std::conditional_t<Const, const L&, L&> {
+        return m_vec->m_errors[m_index - m_vec->rank(m_index)];
       }
     };
 
-    template<typename F>
-    inspect_impl(F&&) -> inspect_impl<F>;
+  public:
+    using reference = reference_proxy<false>;
+    using const_reference = reference_proxy<true>;
+    using iterator = detail::proxy_iterator<either_vector, reference>;
+    using const_iterator = detail::proxy_iterator<const either_vector, const_reference>;
+    using size_type = std::size_t;
 
+    either_vector() = default;
 
-    template<typename F>
-    struct inspect_err_impl {
-      F ins_f;
+    /**
+    * @brief 有効値を末尾に構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<R, Args...>
+    constexpr auto emplace_value(Args&&... args) -> R& {
+      m_values.emplace_back(std::forward<Args>(args)...);
+      push_bit(true);
+      return m_values.back();
+    }
 
-      template<maybe M>
-        requires std::invocable<F, lvalue_as_const_t<traits::unwrap_other_t<M>>> and
-                 std::same_as<std::invoke_result_t<F, lvalue_as_const_t<traits::unwrap_other_t<M>>>, void>
-      friend constexpr auto operator|(monas<M>&& m, inspect_err_impl&& self) -> monas<M>&& {
-        if (not cpo::validate(m)) {
-          std::invoke(std::move(self.ins_f), lvalue_as_const(cpo::unwrap_other(m)));
+    /**
+    * @brief 無効値を末尾に構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<L, Args...>
+    constexpr auto emplace_error(Args&&... args) -> L& {
+      m_errors.emplace_back(std::forward<Args>(args)...);
+      push_bit(false);
+      return m_errors.back();
+    }
+
+    /**
+    * @brief eitherな値を末尾に追加する
+    */
+    template<either E>
+      requires std::constructible_from<R, traits::unwrap_t<E>> and
+               std::constructible_from<L, traits::unwrap_other_t<E>>
+    constexpr void push_back(E&& e) {
+      if (cpo::validate(e)) {
+        emplace_value(cpo::unwrap(std::forward<E>(e)));
+      } else {
+        emplace_error(cpo::unwrap_other(std::forward<E>(e)));
+      }
+    }
+
+    /**
+    * @brief 要素数nのための領域を予約する
+    * @param valid_ratio 有効値の割合の見込み
+    */
+    constexpr void reserve(std::size_t n, double valid_ratio = 1.0) {
+      const auto values = static_cast<std::size_t>(double(n) * valid_ratio);
+      m_bits.reserve((n + word_bits - 1) / word_bits);
+      m_rank.reserve((n + word_bits - 1) / word_bits);
+      m_values.reserve(values);
+      m_errors.reserve(n - std::min(n, values));
+    }
+
+    constexpr void clear() noexcept {
+      m_bits.clear();
+      m_rank.clear();
+      m_values.clear();
+      m_errors.clear();
+      m_size = 0;
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> std::size_t {
+      return m_size;
+    }
+
+    [[nodiscard]]
+    constexpr bool empty() const noexcept {
+      return m_size == 0;
+    }
+
+    [[nodiscard]]
+    constexpr bool valid(std::size_t i) const noexcept {
+      return (m_bits[i / word_bits] >> (i % word_bits)) & 1;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t i) noexcept -> reference {
+      return { this, i };
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t i) const noexcept -> const_reference {
+      return { this, i };
+    }
+
+    /**
+    * @brief 有効値の密な配列
+    */
+    [[nodiscard]]
+    constexpr auto values() noexcept -> std::span<R> {
+      return m_values;
+    }
+
+    [[nodiscard]]
+    constexpr auto values() const noexcept -> std::span<const R> {
+      return m_values;
+    }
+
+    /**
+    * @brief 無効値の密な配列
+    */
+    [[nodiscard]]
+    constexpr auto errors() noexcept -> std::span<L> {
+      return m_errors;
+    }
+
+    [[nodiscard]]
+    constexpr auto errors() const noexcept -> std::span<const L> {
+      return m_errors;
+    }
+
+    /**
+    * @brief ビットマスクのセットされたビットを走査し、有効な要素の位置と値でfを呼び出す
+    */
+    template<std::invocable<std::size_t, R&> F>
+    constexpr void for_each_valid(F&& f) {
+      std::size_t dense = 0;
+
+      for (std::size_t w = 0; w < m_bits.size(); ++w) {
+        for (std::uint64_t bits = m_bits[w]; bits != 0; bits &= bits - 1) {
+          f(w * word_bits + static_cast<std::size_t>(std::countr_zero(bits)), m_values[dense++]);
         }
-        return std::move(m);
       }
-    };
+    }
 
+    /**
+    * @brief 有効値にだけfを適用して再代入する、listモナドとしてのbindから呼ばれる
+    * @details 有効値は密に並んでいるため、無効な要素には一切触れずに連続領域をループできる
+    */
     template<typename F>
-    inspect_err_impl(F&&) -> inspect_err_impl<F>;
-  }
+      requires std::invocable<F&, R&> and
+               std::assignable_from<R&, std::invoke_result_t<F&, R&>>
+    constexpr void bind_valid(F& f) {
+      detail::bind_elements(m_values.begin(), m_values.end(), f);
+    }
 
-  inline constexpr auto inspect = []<typename F>(F&& f) {
-    return detail::inspect_impl{ .ins_f = std::forward<F>(f) };
-  };
+    [[nodiscard]]
+    constexpr auto begin() noexcept -> iterator { return { this, 0 }; }
 
-  inline constexpr auto inspect_err = []<typename F>(F&& f) {
-    return detail::inspect_err_impl{ .ins_f = std::forward<F>(f) };
+    [[nodiscard]]
+    constexpr auto end() noexcept -> iterator { return { this, static_cast<std::ptrdiff_t>(m_size) }; }
+
+    [[nodiscard]]
+    constexpr auto begin() const noexcept -> const_iterator { return { this, 0 }; }
+
+    [[nodiscard]]
+    constexpr auto end() const noexcept -> const_iterator { return { this, static_cast<std::ptrdiff_t>(m_size) }; }
   };
-}
 
+} // namespace harmony
+
+namespace harmony {
+
+  /**
+  * @brief 値の連続領域と、要素毎に1ビットの有効性ビットマップで構成される、nullを含みうる列
+  * @details ビットマップはApache Arrowと同じく、i番目の要素の有効性をi / 8バイト目のi % 8ビット目（LSBから数える）で表す。
+  * 無効な要素の位置にも値の領域は存在し、その値は不定（追加時はデフォルト構築される）。listモナドとして扱え、bindは有効な要素だけに適用される
+  * @tparam T 要素の型
+  */
+  template<typename T>
+    requires std::default_initializable<T>
+  class nullable_column {
+    static constexpr std::size_t word_bits = 64;
+
+    std::vector<T> m_values;
+    // 要素数を超える部分のビットは常に0
+    std::vector<std::uint64_t> m_bits;
+    std::size_t m_null_count = 0;
+
+    constexpr void push_bit(bool valid) {
+      const std::size_t i = m_values.size() - 1;
+
+      if (i % word_bits == 0) {
+        m_bits.push_back(0);
+      }
+      if (valid) {
+        m_bits.back() |= std::uint64_t(1) << (i % word_bits);
+      } else {
+        ++m_null_count;
+      }
+    }
+
+    /**
+    * @brief 要素への参照として振る舞うプロキシ、maybeとして扱える
+    */
+    template<bool Const>
+    class reference_proxy {
+      using column_t = std::conditional_t<Const, const nullable_column, nullable_column>;
+
+      column_t* m_col;
+      std::size_t m_index;
+
+    public:
+
+      constexpr reference_proxy(column_t* col, std::size_t index) noexcept
+        : m_col(col)
+        , m_index(index)
+      {}
+
+      [[nodiscard]]
+      constexpr explicit operator bool() const noexcept {
+        return m_col->is_valid(m_index);
+      }
+
+      [[nodiscard]]
+      constexpr auto operator*() const noexcept -> std::conditional_t<Const, const T&, T&> {
+        return m_col->m_values[m_index];
+      }
+    };
+
+  public:
+    using element_type = T;
+    using reference = reference_proxy<false>;
+    using const_reference = reference_proxy<true>;
+    using iterator = detail::proxy_iterator<nullable_column, reference>;
+    using const_iterator = detail::proxy_iterator<const nullable_column, const_reference>;
+    using size_type = std::size_t;
+
+    nullable_column() = default;
+
+    /**
+    * @brief maybeな値の範囲から構築する
+    */
+    template<std::ranges::input_range R>
+      requires (not std::same_as<std::remove_cvref_t<R>, nullable_column>) and
+               maybe<std::ranges::range_reference_t<R>> and
+               std::constructible_from<T, traits::unwrap_t<std::ranges::range_reference_t<R>>>
+    constexpr explicit nullable_column(R&& r) {
+      if constexpr (std::ranges::sized_range<R>) {
+        reserve(std::ranges::size(r));
+      }
+      for (auto&& m : r) {
+        push_back(std::forward<decltype(m)>(m));
+      }
+    }
+
+    /**
+    * @brief 有効値を末尾に構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<T, Args...>
+    constexpr auto emplace_back(Args&&... args) -> T& {
+      m_values.emplace_back(std::forward<Args>(args)...);
+      push_bit(true);
+      return m_values.back();
+    }
+
+    constexpr void push_back(const T& v) {
+      emplace_back(v);
+    }
+
+    constexpr void push_back(T&& v) {
+      emplace_back(std::move(v));
+    }
+
+    /**
+    * @brief maybeな値を末尾に追加する
+    */
+    template<maybe M>
+      requires (not std::same_as<std::remove_cvref_t<M>, T>) and
+               std::constructible_from<T, traits::unwrap_t<M>>
+    constexpr void push_back(M&& m) {
+      if (cpo::validate(m)) {
+        emplace_back(cpo::unwrap(std::forward<M>(m)));
+      } else {
+        push_null();
+      }
+    }
+
+    /**
+    * @brief 無効値を末尾に追加する
+    */
+    constexpr void push_null() {
+      m_values.emplace_back();
+      push_bit(false);
+    }
+
+    /**
+    * @brief i番目の要素を無効値にする
+    */
+    constexpr void set_null(std::size_t i) noexcept {
+      const std::uint64_t mask = std::uint64_t(1) << (i % word_bits);
+
+      if (m_bits[i / word_bits] & mask) {
+        m_bits[i / word_bits] &= ~mask;
+        ++m_null_count;
+      }
+    }
+
+    constexpr void reserve(std::size_t n) {
+      m_values.reserve(n);
+      m_bits.reserve((n + word_bits - 1) / word_bits);
+    }
+
+    constexpr void clear() noexcept {
+      m_values.clear();
+      m_bits.clear();
+      m_null_count = 0;
+    }
+
+    [[nodiscard]]
+    constexpr auto size() const noexcept -> std::size_t {
+      return m_values.size();
+    }
+
+    [[nodiscard]]
+    constexpr bool empty() const noexcept {
+      return m_values.empty();
+    }
+
+    /**
+    * @brief 無効値の数
+    */
+    [[nodiscard]]
+    constexpr auto null_count() const noexcept -> std::size_t {
+      return m_null_count;
+    }
+
+    [[nodiscard]]
+    constexpr bool is_valid(std::size_t i) const noexcept {
+      return (m_bits[i / word_bits] >> (i % word_bits)) & 1;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t i) noexcept -> reference {
+      return { this, i };
+    }
+
+    [[nodiscard]]
+    constexpr auto operator[](std::size_t i) const noexcept -> const_reference {
+      return { this, i };
+    }
+
+    /**
+    * @brief 値の連続領域、無効な要素の位置の値は不定
+    */
+    [[nodiscard]]
+    constexpr auto values() noexcept -> std::span<T> {
+      return m_values;
+    }
+
+    [[nodiscard]]
+    constexpr auto values() const noexcept -> std::span<const T> {
+      return m_values;
+    }
+
+    /**
+    * @brief 64ビットワード単位の有効性ビットマップ
+    */
+    [[nodiscard]]
+    constexpr auto validity_words() const noexcept -> std::span<const std::uint64_t> {
+      return m_bits;
+    }
+
+    /**
+    * @brief バイト単位の有効性ビットマップ、Apache Arrowのvalidity bufferと同じレイアウト
+    * @details 長さは(size() + 7) / 8バイト。ワードのバイト列をそのまま見せるため、リトルエンディアンの環境でのみ利用可能
+    */
+    [[nodiscard]]
+    auto validity_bitmap() const noexcept -> std::span<const std::byte>
+      requires (std::endian::native == std::endian::little)
+    {
+      return { reinterpret_cast<const std::byte*>(m_bits.data()), (size() + 7) / 8 };
+    }
+
+    /**
+    * @brief 有効な要素にだけfを適用して再代入する、listモナドとしてのbindから呼ばれる
+    * @details ビットマップをワード単位で走査し、連続して有効な要素の範囲毎にループする。無効値しかないワードは読み飛ばす
+    */
+    template<typename F>
+      requires std::invocable<F&, T&> and
+               std::assignable_from<T&, std::invoke_result_t<F&, T&>>
+    constexpr void bind_valid(F& f) {
+      T* p = m_values.data();
+
+      detail::for_each_valid_run(m_bits, [&](std::size_t first, std::size_t last) {
+        for (std::size_t i = first; i < last; ++i) {
+          p[i] = f(p[i]);
+        }
+      });
+    }
+
+    [[nodiscard]]
+    constexpr auto begin() noexcept -> iterator { return { this, 0 }; }
+
+    [[nodiscard]]
+    constexpr auto end() noexcept -> iterator { return { this, static_cast<std::ptrdiff_t>(size()) }; }
+
+    [[nodiscard]]
+    constexpr auto begin() const noexcept -> const_iterator { return { this, 0 }; }
+
+    [[nodiscard]]
+    constexpr auto end() const noexcept -> const_iterator { return { this, static_cast<std::ptrdiff_t>(size()) }; }
+  };
+
+} // namespace harmony
+
+
+namespace harmony::detail {
+
+  template<typename F, typename M>
+  constexpr bool check_nothrow_reuse_map_err() {
+    if constexpr (detail::map_err_reusable<F&, M>) {
+      return noexcept(std::declval<M>().map_err(std::declval<F>()));
+    } else {
+      return noexcept(std::declval<M>().map_error(std::declval<F>()));
+    }
+  }
+
+  template<typename F, typename M>
+  concept map_err_func_reusable = map_err_reusable<F, M> or map_error_reusable<F, M>;
+
+  template<typename F, typename M>
+  concept not_map_err_func_reusable = not map_err_func_reusable<F, M>;
+
+
+  template<typename F>
+  struct map_err_impl {
+
+    [[no_unique_address]] F fmap;
+
+    template<either M>
+      requires map_err_func_reusable<F&, M> and
+               not_void_resulted<F, traits::unwrap_other_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_err_impl self) noexcept(check_nothrow_reuse_map_err<F&, M>()) {
+      if constexpr (map_err_reusable<F&, M>) {
+        return monas(std::forward<M>(m).map_err(self.fmap));
+      } else {
+        return monas(std::forward<M>(m).map_error(self.fmap));
+      }
+    }
+
+    template<either M>
+      requires not_map_err_func_reusable<F&, M> and
+               not_void_resulted<F, traits::unwrap_other_t<M>> and
+               either<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_err_impl self) {
+      using result_t = std::remove_cv_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>;
+
+      if (cpo::validate(m)) {
+        static_assert(std::constructible_from<result_t, traits::unwrap_t<M>>, "Cannot convert right value type");
+        // そのまま構築を試みる
+        return monas<result_t>(cpo::unwrap(std::forward<M>(m)));
+      } else {
+        return monas<result_t>(self.fmap(cpo::unwrap_other(std::forward<M>(m))));
+      }
+    }
+    
+    template<either M>
+      requires not_map_err_func_reusable<F&, M> and
+               not_void_resulted<F, traits::unwrap_other_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, map_err_impl self) {
+      // 有効値の型
+      using R = std::remove_cvref_t<traits::unwrap_t<M>>;
+      // 無効値の型
+      using L = std::remove_cvref_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>;
+      
+      if (cpo::validate(m)) {
+        return monas<sachet<L, R>>(std::in_place, std::in_place_index<1>, cpo::unwrap(std::forward<M>(m)));
+      } else {
+        return monas<sachet<L, R>>(std::in_place, std::in_place_index<0>, self.fmap(cpo::unwrap_other(std::forward<M>(m))));
+      }
+    }
+
+  };
+
+  template<typename F>
+  map_err_impl(F&&) -> map_err_impl<F>;
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief Eitherモナドな型に対してmap_errを適用する（無効地を任意の型の値へ写す）
+  * @brief M<T, E>のような型をM<T, F>のように変換する（Either<L, R>をEither<M, R>へ変換する）
+  * @param f E -> F へmapするCallableオブジェクト
+  */
+  inline constexpr auto map_err = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::map_err_impl<F> {
+    return detail::map_err_impl{ .fmap = std::forward<F>(f) };
+  };
+
+} // namespace harmony::inline monadic_op
+
+
+namespace harmony::detail {
+
+  template<typename F, typename M, typename R = std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_t<M>>>>
+  inline constexpr bool check_nothrow_and_then_v =
+    std::is_nothrow_invocable_v<F, traits::unwrap_t<M>> and
+    std::is_nothrow_constructible_v<monas<R>, R> and
+    std::is_nothrow_constructible_v<monas<R>, traits::unwrap_other_t<M>>;
+  
+
+
+  template<typename F>
+  struct and_then_impl {
+
+    [[no_unique_address]] F fmap;
+    
+    template<either M>
+      requires not_and_then_reusable<F&, M> and
+               std::invocable<F, traits::unwrap_t<M>> and
+               either<std::invoke_result_t<F, traits::unwrap_t<M>>> and
+               std::constructible_from<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_t<M>>>, traits::unwrap_other_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, and_then_impl self) noexcept(noexcept(cpo::validate(m)) and check_nothrow_and_then_v<F, M>) {
+      // 呼び出し結果が左辺値参照を返すとき、コピーされることになる
+      // mが有効値を保持していないとき、戻り値のmonasはmの無効値をムーブするしかない（参照するのは危険）
+      //using ret_either_t = std::remove_reference_t<decltype(self.fmap(cpo::unwrap(std::forward<M>(m))))>;
+      using result_t = std::remove_cvref_t<std::invoke_result_t<F&, traits::unwrap_t<M>>>;
+
+      if (cpo::validate(m)) {
+        return monas<result_t>(self.fmap(cpo::unwrap(std::forward<M>(m))));
+      } else {
+        static_assert(std::constructible_from<result_t, traits::unwrap_other_t<M>>, "Cannot convert left value type");
+        return monas<result_t>(cpo::unwrap_other(std::forward<M>(m)));
+      }
+    }
+
+    template<either M>
+      requires and_then_reusable<F&, M>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, and_then_impl self) noexcept(noexcept(monas(std::forward<M>(m).and_then(self.fmap)))) {
+      return monas(std::forward<M>(m).and_then(self.fmap));
+    }
+  };
+  
+  template<typename F>
+  and_then_impl(F&&) -> and_then_impl<F>;
+}
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief Eitherモナドな型の有効値をmapした別のEither型へ変換する（有効値だけを変換し、無効値はそのまま）
+  * @brief M<T, E>のような型をN<U, E>のように変換する（Either1<L, R>をEither2<L, S>へ変換する）
+  * @param f T -> N<U, E> へmapするCallableオブジェクト（戻り値型はEitherを返さなければならない）
+  */
+  inline constexpr auto and_then = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::and_then_impl<F> {
+    return detail::and_then_impl{ .fmap = std::forward<F>(f) };
+  };
+}
+
+
+namespace harmony::detail {
+
+  template<typename F, typename M, typename R = std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>>
+  inline constexpr bool check_nothrow_or_else_v =
+    std::is_nothrow_invocable_v<F, traits::unwrap_other_t<M>> and
+    std::is_nothrow_constructible_v<monas<R>, R> and
+    std::is_nothrow_constructible_v<monas<R>, traits::unwrap_t<M>>;
+
+
+  template<typename F>
+  struct or_else_impl {
+
+    [[no_unique_address]] F fmap;
+
+    template<either M>
+      requires not_or_else_reusable<F&, M> and
+               std::invocable<F, traits::unwrap_other_t<M>> and
+               either<std::invoke_result_t<F, traits::unwrap_other_t<M>>> and
+               std::constructible_from<std::remove_reference_t<std::invoke_result_t<F, traits::unwrap_other_t<M>>>, traits::unwrap_t<M>>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, or_else_impl self) noexcept(noexcept(cpo::validate(m)) and check_nothrow_or_else_v<F, M>) {
+      // 呼び出し結果が左辺値参照を返すとき、コピーされることになる
+      // mが有効値を保持しているとき、戻り値のmonasはmの有効値をムーブするしかない（参照するのは危険）
+      //using ret_either_t = std::remove_reference_t<decltype(self.fmap(cpo::unwrap_other(std::forward<M>(m))))>;
+      using result_t = std::remove_cvref_t<std::invoke_result_t<F &, traits::unwrap_other_t<M>>>;
+
+      if (cpo::validate(m)) {
+        static_assert(std::constructible_from<result_t, traits::unwrap_t<M>>, "Cannot convert right value type");
+        return monas<result_t>(cpo::unwrap(std::forward<M>(m)));
+      } else {
+        return monas<result_t>(self.fmap(cpo::unwrap_other(std::forward<M>(m))));
+      }
+    }
+
+    template<either M>
+      requires or_else_reusable<F&, M>
+    friend constexpr specialization_of<monas> auto operator|(M&& m, or_else_impl self) noexcept(noexcept(monas(std::forward<M>(m).or_else(self.fmap)))) {
+      return monas(std::forward<M>(m).or_else(self.fmap));
+    }
+    
+  };
+  
+  template<typename F>
+  or_else_impl(F&&) -> or_else_impl<F>;
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief Eitherモナドな型の無効値をmapした別のEither型へ変換する（無効値だけを変換し、有効値はそのまま）
+  * @brief M<T, E>のような型をN<T, F>のように変換する（Either1<L, R>をEither2<L, S>へ変換する）
+  * @param f E -> N<T, F> へmapするCallableオブジェクト（戻り値型はEitherを返さなければならない）
+  */
+  inline constexpr auto or_else = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::or_else_impl<F> {
+    return detail::or_else_impl{ .fmap = std::forward<F>(f) };
+  };
+}
+
+namespace harmony::detail {
+
+  template<typename Fok, typename Ferr>
+  struct match_impl {
+    [[no_unique_address]] Fok  fmap_ok;
+    [[no_unique_address]] Ferr fmap_err;
+
+    template<typename R, typename M, typename Fe>
+    constexpr auto invoke_impl(M&& m, Fe& ferr) {
+      if constexpr (unwrappable<R>) {
+        if (cpo::validate(m)) {
+          return monas<R>(this->fmap_ok(cpo::unwrap(std::forward<M>(m))));
+        } else {
+          return monas<R>(ferr(cpo::unwrap_other(std::forward<M>(m))));
+        }
+      } else {
+        // なぜかR=voidの時もこのまま動くらしい（本当にポータブル？）
+        if (cpo::validate(m)) {
+          return static_cast<R>(this->fmap_ok(cpo::unwrap(std::forward<M>(m))));
+        } else {
+          return static_cast<R>(ferr(cpo::unwrap_other(std::forward<M>(m))));
+        }
+      }
+    }
+
+
+    template<either M>
+      requires std::invocable<Fok, traits::unwrap_t<M>> and
+               std::invocable<Ferr, traits::unwrap_other_t<M>> and
+               std::common_with<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Ferr, traits::unwrap_other_t<M>>>
+    friend constexpr auto operator|(M&& m, match_impl self) {
+      using result_t = std::common_type_t<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Ferr, traits::unwrap_other_t<M>>>;
+
+      return self.invoke_impl<result_t>(std::forward<M>(m), self.fmap_err);
+    }
+
+    template<either M>
+      requires std::same_as<nil, Ferr> and
+               std::invocable<Fok, traits::unwrap_t<M>> and
+               std::invocable<Fok, traits::unwrap_other_t<M>> and
+               std::common_with<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Fok, traits::unwrap_other_t<M>>>
+    friend constexpr auto operator|(M&& m, match_impl self) {
+      using result_t = std::common_type_t<std::invoke_result_t<Fok, traits::unwrap_t<M>>, std::invoke_result_t<Fok, traits::unwrap_other_t<M>>>;
+
+      return self.invoke_impl<result_t>(std::forward<M>(m), self.fmap_ok);
+    }
+  };
+
+  template<typename Fok, typename Ferr>
+  match_impl(Fok&&, Ferr&&) -> match_impl<Fok, Ferr>;
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief Eitherモナドな型の有効値と無効値をmapする
+  * @brief M<T, E>のような型の有効値と無効値をそれぞれ共通の型Rに変換する
+  * @param fok T -> R へmapするCallableオブジェクト
+  * @param fee E -> R へmapするCallableオブジェクト（省略された場合、どちらに対してもfokによるmapを試みる）
+  * @return Rがunwrappableならばmonas<R>、それ以外の場合はRのオブジェクト、R = voidならば戻り値はない
+  */
+  inline constexpr auto match = []<typename Fok, typename Ferr = nil>(Fok&& fok, Ferr&& ferr = {}) noexcept(std::is_nothrow_move_constructible_v<Fok> and std::is_nothrow_move_constructible_v<Ferr>) -> detail::match_impl<Fok, Ferr> {
+    return detail::match_impl{ .fmap_ok = std::forward<Fok>(fok), .fmap_err = std::forward<Ferr>(ferr) };
+  };
+
+  inline constexpr auto &fold = match;
+
+} // namespace harmony::inline monadic_op
+
+namespace harmony::detail {
+
+  /**
+  * @brief 要素単位の検査をブロック毎にまとめて行える範囲、トリビアルな要素の連続範囲
+  */
+  template<typename R>
+  concept bulk_checkable =
+    std::ranges::contiguous_range<R> and
+    std::ranges::sized_range<R> and
+    std::is_trivially_copyable_v<std::ranges::range_value_t<R>>;
+
+  /**
+  * @brief 分岐せずに検査する要素数の単位、ブロック毎に早期終了の判定をする
+  * @details ブロック内の数を8ビットで数えられる大きさにしておくと、要素が小さい場合にバイト単位でベクトル化されやすい
+  */
+  inline constexpr std::size_t validity_block = 128;
+
+  template<typename Pred>
+  struct exists_impl {
+    [[no_unique_address]] Pred f_pred;
+
+    template<maybe M>
+      requires std::predicate<Pred, traits::unwrap_t<M>>
+    friend constexpr bool operator|(M&& m, exists_impl self) noexcept(noexcept(cpo::validate(m)) and noexcept(self.f_pred(cpo::unwrap(m)))) {
+      if (cpo::validate(m)) {
+        return self.f_pred(cpo::unwrap(m));
+      }
+      return false;
+    }
+
+    template<list M>
+      requires (not bitmap_column<std::remove_cvref_t<M>>) and
+               std::predicate<Pred, std::ranges::range_reference_t<M>>
+    friend constexpr bool operator|(M&& m, exists_impl self) noexcept(noexcept(std::is_nothrow_invocable_r_v<bool, Pred, std::ranges::range_reference_t<M>>)) {
+      auto it = std::ranges::begin(m);
+      const auto fin = std::ranges::end(m);
+
+      for (; it != fin; ++it) {
+        if (self.f_pred(*it)) return true;
+      }
+
+      return false;
+    }
+
+    /**
+    * @brief 列の有効値のいずれかが条件を満たすかをチェックする
+    * @details ビットマップをワード単位で読み、無効値しかないワードは読み飛ばす
+    */
+    template<typename M>
+      requires bitmap_column<std::remove_cvref_t<M>> and
+               std::predicate<Pred&, const typename std::remove_cvref_t<M>::element_type&>
+    friend constexpr bool operator|(M&& m, exists_impl self) {
+      const auto values = std::as_const(m).values();
+      const auto words = std::as_const(m).validity_words();
+
+      for (std::size_t w = 0; w < words.size(); ++w) {
+        for (std::uint64_t bits = words[w]; bits != 0; bits &= bits - 1) {
+          if (self.f_pred(values[w * 64 + static_cast<std::size_t>(std::countr_zero(bits))])) return true;
+        }
+      }
+
+      return false;
+    }
+  };
+
+  template<typename F>
+  exists_impl(F&&) -> exists_impl<F>;
+}
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief maybeモナドな型の有効値が指定された条件を満たすかをチェックする
+  * @param f 有効値に対する述語オブジェクト
+  * @return 無効値を保持していた場合はfalse、そうでなければfを適用した結果のbool値
+  */
+  inline constexpr auto exists = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::exists_impl<F> {
+    return detail::exists_impl{ .f_pred = std::forward<F>(f) };
+  };
+
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief 述語の結果を反転する
+  */
+  template<typename Pred>
+  struct negated_pred {
+    [[no_unique_address]] Pred pred;
+
+    template<typename T>
+      requires std::predicate<Pred&, T>
+    constexpr bool operator()(T&& t) {
+      return not std::invoke(pred, std::forward<T>(t));
+    }
+
+    template<typename T>
+      requires std::predicate<const Pred&, T>
+    constexpr bool operator()(T&& t) const {
+      return not std::invoke(pred, std::forward<T>(t));
+    }
+  };
+
+  /**
+  * @brief rの[first, last)の要素のいずれかがpredを満たすかを調べる
+  * @details 要素毎に短絡し、validity_block要素毎にcancelを確認して、他のワーカーが見つけていればそこで打ち切る
+  */
+  template<typename R, typename Pred>
+  bool exists_in_chunk(R& r, std::size_t first, std::size_t last, Pred& pred, const std::atomic<bool>& cancel) {
+    auto it = std::ranges::begin(r) + static_cast<std::ranges::range_difference_t<R>>(first);
+
+    for (std::size_t i = first; i < last; ++i, ++it) {
+      if ((i - first) % validity_block == 0 and cancel.load(std::memory_order_relaxed)) return false;
+      if (pred(*it)) return true;
+    }
+
+    return false;
+  }
+
+  template<typename Pred>
+  struct par_exists_impl {
+    [[no_unique_address]] Pred f_pred;
+    std::size_t grain;
+    parallel_executor_ref exec{};
+
+    /**
+    * @brief ランダムアクセス可能なlistを分割して並列に調べる
+    * @details 見つけたワーカーは共有フラグを立て、他のワーカーは高々validity_block要素の後に打ち切る
+    */
+    template<typename M>
+      requires parallel_list<M> and
+               (not bitmap_column<std::remove_cvref_t<M>>) and
+               std::predicate<Pred&, std::ranges::range_reference_t<M>>
+    friend bool operator|(M&& m, par_exists_impl self) {
+      auto& r = m;
+      std::atomic<bool> found = false;
+
+      parallel_chunks(self.exec, static_cast<std::size_t>(std::ranges::size(r)), self.grain, [&](std::size_t b, std::size_t e) {
+        if (exists_in_chunk(r, b, e, self.f_pred, found)) {
+          found.store(true, std::memory_order_relaxed);
+        }
+      });
+
+      return found.load(std::memory_order_relaxed);
+    }
+
+    /**
+    * @brief 並列化できない型に対しては逐次のexistsにフォールバックする
+    */
+    template<typename M>
+      requires (not parallel_list<M> or bitmap_column<std::remove_cvref_t<M>>) and
+               requires(M&& m, exists_impl<Pred&> e) { { std::forward<M>(m) | e } -> std::same_as<bool>; }
+    friend constexpr bool operator|(M&& m, par_exists_impl self) {
+      return std::forward<M>(m) | exists_impl<Pred&>{ self.f_pred };
+    }
+  };
+
+  /**
+  * @brief 否定した述語に対するexistsの結果を反転して、全ての値が条件を満たすかを得る
+  * @tparam Op 否定した述語を持つexists_implかpar_exists_impl
+  */
+  template<typename Op>
+  struct for_all_impl {
+    Op op;
+
+    template<typename M>
+      requires requires(M&& m, Op&& op) { { std::forward<M>(m) | std::move(op) } -> std::same_as<bool>; }
+    friend constexpr bool operator|(M&& m, for_all_impl self) {
+      return not (std::forward<M>(m) | std::move(self.op));
+    }
+  };
+}
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief existsを並列に行う、ランダムアクセス可能なlistは分割してワーカー毎に調べる
+  * @details 述語は複数のスレッドから同時に呼ばれる。並列化できない型に対してはexistsと同じ
+  * @param f 値に対する述語オブジェクト
+  * @param grain 1ワーカーが担当する最小要素数
+  * @param exec ワーカーを動かすexecutor（省略可能）、参照で保持する。省略した場合はプロセスで共有するthread_poolを使用する
+  */
+  inline constexpr auto par_exists = []<typename F, executor... E>(F&& f, std::size_t grain = detail::default_parallel_grain, E&... exec) noexcept(std::is_nothrow_move_constructible_v<F>) -> detail::par_exists_impl<F>
+    requires (sizeof...(E) <= 1)
+  {
+    return detail::par_exists_impl<F>{ .f_pred = std::forward<F>(f), .grain = grain, .exec = detail::parallel_executor_ref(exec...) };
+  };
+
+  /**
+  * @brief 全ての値が指定された条件を満たすかをチェックする
+  * @param f 値に対する述語オブジェクト
+  * @return maybeな型が無効値を保持していた場合、及び空のlistに対してはtrue
+  */
+  inline constexpr auto for_all = []<typename F>(F&& f) noexcept(std::is_nothrow_move_constructible_v<F>) {
+    return detail::for_all_impl<detail::exists_impl<detail::negated_pred<F>>>{ { { std::forward<F>(f) } } };
+  };
+
+  /**
+  * @brief for_allを並列に行う、条件を満たさない要素を見つけたワーカーは他のワーカーを打ち切る
+  * @param f 値に対する述語オブジェクト
+  * @param grain 1ワーカーが担当する最小要素数
+  * @param exec ワーカーを動かすexecutor（省略可能）、参照で保持する。省略した場合はプロセスで共有するthread_poolを使用する
+  */
+  inline constexpr auto par_for_all = []<typename F, executor... E>(F&& f, std::size_t grain = detail::default_parallel_grain, E&... exec) noexcept(std::is_nothrow_move_constructible_v<F>)
+    requires (sizeof...(E) <= 1)
+  {
+    return detail::for_all_impl<detail::par_exists_impl<detail::negated_pred<F>>>{ { { std::forward<F>(f) }, grain, detail::parallel_executor_ref(exec...) } };
+  };
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief 有効性を検査できる要素、maybeな型か、NaNを無効値とみなす浮動小数点数型
+  */
+  template<typename E>
+  concept validity_checkable = std::floating_point<std::remove_cvref_t<E>> or maybe<E>;
+
+  /**
+  * @brief 要素の有効性を得る、浮動小数点数はharmonizeと同じくNaNを無効値とする
+  */
+  template<typename E>
+  constexpr bool element_valid(const E& e) {
+    if constexpr (std::floating_point<E>) {
+      // NaNだけが自分自身と等しくない
+      return e == e;
+    } else {
+      return cpo::validate(e);
+    }
+  }
+
+  /**
+  * @brief [p, p + n)の有効な要素を分岐せずに数える、nはvalidity_block以下
+  */
+  template<typename E>
+  constexpr auto count_valid_block(const E* p, std::size_t n) -> std::size_t {
+    // ポインタや浮動小数点数は比較結果が要素と同じ幅になるので同じ幅で数え、それ以外（bool値を持つstd::optionalなど）はバイト単位で数える
+    using counter_t = std::conditional_t<std::is_scalar_v<E>, std::size_t, std::uint8_t>;
+    static_assert(validity_block < 256);
+
+    counter_t count = 0;
+
+    for (std::size_t i = 0; i < n; ++i) {
+      count += counter_t(element_valid(p[i]));
+    }
+
+    return count;
+  }
+
+  enum class validity_query {
+    count_valid,
+    all_valid,
+    any_valid,
+    first_invalid,
+  };
+
+  template<typename R>
+  concept validity_queryable =
+    bitmap_column<std::remove_cvref_t<R>> or
+    (std::ranges::input_range<R> and validity_checkable<std::ranges::range_reference_t<R>>);
+
+  /**
+  * @brief 範囲の要素の有効性に関する問い合わせ
+  * @details 連続範囲はvalidity_block要素毎に分岐なしで数えてから判定し、ビットマップを持つ列はワード単位で判定する
+  */
+  template<validity_query Q>
+  struct validity_query_impl {
+
+    /**
+    * @brief 問い合わせの本体、first_invalidの場合は最初の無効値の位置（なければ末尾）の添え字を返す
+    */
+    template<typename R>
+    static constexpr auto run(R& r) {
+      if constexpr (bitmap_column<std::remove_cvref_t<R>>) {
+        return run_bitmap(r.validity_words(), r.size());
+      } else if constexpr (bulk_checkable<R>) {
+        return run_contiguous(std::ranges::data(r), std::ranges::size(r));
+      } else {
+        return run_serial(r);
+      }
+    }
+
+    static constexpr auto run_bitmap(std::span<const std::uint64_t> words, std::size_t size) noexcept {
+      if constexpr (Q == validity_query::count_valid) {
+        std::size_t count = 0;
+        for (auto w : words) count += static_cast<std::size_t>(std::popcount(w));
+        return count;
+      } else if constexpr (Q == validity_query::any_valid) {
+        return std::ranges::any_of(words, [](std::uint64_t w) { return w != 0; });
+      } else {
+        // 要素数を超える部分のビットは0なので、最初に0のビットが見つかった位置が要素数以上なら全て有効
+        std::size_t index = size;
+        for (std::size_t w = 0; w < words.size(); ++w) {
+          if (~words[w] != 0) {
+            index = std::min(size, w * 64 + static_cast<std::size_t>(std::countr_zero(~words[w])));
+            break;
+          }
+        }
+
+        if constexpr (Q == validity_query::all_valid) {
+          return index == size;
+        } else {
+          return index;
+        }
+      }
+    }
+
+    template<typename E>
+    static constexpr auto run_contiguous(const E* p, std::size_t n) {
+      if constexpr (Q == validity_query::count_valid) {
+        std::size_t count = 0;
+        for (std::size_t first = 0; first < n; first += validity_block) {
+          count += count_valid_block(p + first, std::min(validity_block, n - first));
+        }
+        return count;
+      } else {
+        for (std::size_t first = 0; first < n; first += validity_block) {
+          const std::size_t len = std::min(validity_block, n - first);
+          const std::size_t count = count_valid_block(p + first, len);
+
+          if constexpr (Q == validity_query::any_valid) {
+            if (count != 0) return true;
+          } else if (count != len) {
+            if constexpr (Q == validity_query::all_valid) {
+              return false;
+            } else {
+              std::size_t i = first;
+              while (element_valid(p[i])) ++i;
+              return i;
+            }
+          }
+        }
+
+        if constexpr (Q == validity_query::any_valid) {
+          return false;
+        } else if constexpr (Q == validity_query::all_valid) {
+          return true;
+        } else {
+          return n;
+        }
+      }
+    }
+
+    template<typename R>
+    static constexpr auto run_serial(R& r) {
+      if constexpr (Q == validity_query::count_valid) {
+        std::size_t count = 0;
+        for (auto&& e : r) count += std::size_t(element_valid(e));
+        return count;
+      } else if constexpr (Q == validity_query::any_valid) {
+        for (auto&& e : r) {
+          if (element_valid(e)) return true;
+        }
+        return false;
+      } else if constexpr (Q == validity_query::all_valid) {
+        for (auto&& e : r) {
+          if (not element_valid(e)) return false;
+        }
+        return true;
+      } else {
+        std::size_t index = 0;
+        for (auto&& e : r) {
+          if (not element_valid(e)) break;
+          ++index;
+        }
+        return index;
+      }
+    }
+
+    /**
+    * @brief first_invalidの結果を範囲のイテレータに変換する
+    */
+    template<typename R, typename I>
+    static constexpr auto to_result(R& r, I result) {
+      if constexpr (Q == validity_query::first_invalid) {
+        return std::ranges::next(std::ranges::begin(r), static_cast<std::ranges::range_difference_t<R>>(result), std::ranges::end(r));
+      } else {
+        return result;
+      }
+    }
+
+    template<typename R>
+      requires (not specialization_of<std::remove_cvref_t<R>, monas>) and
+               validity_queryable<std::remove_reference_t<R>> and
+               (Q != validity_query::first_invalid or std::ranges::forward_range<R>)
+    [[nodiscard]]
+    friend constexpr auto operator|(R&& r, validity_query_impl) {
+      if constexpr (Q == validity_query::first_invalid and not std::ranges::borrowed_range<R>) {
+        return std::ranges::dangling{};
+      } else {
+        return to_result(r, run(r));
+      }
+    }
+
+    template<typename T>
+      requires validity_queryable<std::remove_reference_t<T>> and
+               (Q != validity_query::first_invalid or std::ranges::forward_range<T>)
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<T>&& m, validity_query_impl) {
+      std::remove_reference_t<T>& r = m;
+
+      if constexpr (Q == validity_query::first_invalid and not std::is_lvalue_reference_v<T>) {
+        return std::ranges::dangling{};
+      } else {
+        return to_result(r, run(r));
+      }
+    }
+  };
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief maybeな値（もしくは浮動小数点数）の範囲の、有効値の数を得る
+  * @details 浮動小数点数はNaNを無効値とみなす。連続範囲やnullable_columnでは分岐せずに数える
+  */
+  inline constexpr detail::validity_query_impl<detail::validity_query::count_valid> count_valid{};
+
+  /**
+  * @brief maybeな値（もしくは浮動小数点数）の範囲の要素が、全て有効値であるかを調べる
+  */
+  inline constexpr detail::validity_query_impl<detail::validity_query::all_valid> all_valid{};
+
+  /**
+  * @brief maybeな値（もしくは浮動小数点数）の範囲に、有効値が1つでもあるかを調べる
+  */
+  inline constexpr detail::validity_query_impl<detail::validity_query::any_valid> any_valid{};
+
+  /**
+  * @brief maybeな値（もしくは浮動小数点数）の範囲で、最初の無効値を指すイテレータを得る
+  * @return 無効値がなければ終端イテレータ、範囲が右辺値で所有されている場合はstd::ranges::dangling
+  */
+  inline constexpr detail::validity_query_impl<detail::validity_query::first_invalid> first_invalid{};
+
+} // namespace harmony::inline monadic_op
+
+namespace harmony::detail {
+
+  /**
+  * @brief Es...のI番目までの例外型を捕捉するtryブロックを内側から順に入れ子にして、bodyを呼び出す
+  * @details 最も内側のブロックがEs...の先頭の型を捕捉するため、catch節を並べた時と同じく先に指定した型が優先される
+  */
+  template<std::size_t I, typename Result, typename... Es, typename Body>
+  constexpr auto invoke_catching_as(Body& body) -> Result {
+#ifdef HARMONY_NO_EXCEPTIONS
+    return body();
+#else
+    using E = std::tuple_element_t<I, std::tuple<Es...>>;
+
+    try {
+      if constexpr (I == 0) {
+        return body();
+      } else {
+        return invoke_catching_as<I - 1, Result, Es...>(body);
+      }
+    } catch (const E& e) {
+      return Result(std::in_place, std::in_place_index<0>, std::in_place_index<I>, e);
+    }
+#endif
+  }
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief 受け取った関数を呼び出し、その結果か例外ポインタのどちらかを保持したeitherを返す
+  * @param f 例外を投げうるCallableオブジェクト
+  * @param args fの引数
+  * @return f(args...)の戻り値型をRとすると、Either<std::exception_ptr, R>のようなオブジェクト
+  */
+  inline constexpr  auto try_catch = []<typename F, typename... Args>(F&& f, Args&&... args) noexcept -> monas<sachet<std::exception_ptr, std::invoke_result_t<F, Args...>>> {
+    using R = std::invoke_result_t<F, Args...>;
+    using either_t = sachet<std::exception_ptr, R>;
+    using return_t = monas<either_t>;
+
+#ifdef HARMONY_NO_EXCEPTIONS
+    return return_t(std::in_place, std::in_place_index<1>, std::invoke(std::forward<F>(f), std::forward<Args>(args)...));
+#else
+    try {
+      return return_t(std::in_place, std::in_place_index<1>, std::invoke(std::forward<F>(f), std::forward<Args>(args)...));
+    } catch(...) {
+      return return_t(std::in_place, std::in_place_index<0>, std::current_exception());
+    }
+#endif
+  };
+
+  /**
+  * @brief 受け取った関数を呼び出し、その結果か捕捉した例外オブジェクトのどちらかを保持したeitherを返す
+  * @details Es...の例外はコピーして保持するため、map_errなどで調べるのにstd::rethrow_exception()は必要ない。
+  * Es...のいずれでもない例外はstd::exception_ptrとして保持する。先に指定した型が優先され、派生クラスの例外は基底クラスとしてスライスされる
+  * @tparam Es 捕捉する例外型
+  * @param f 例外を投げうるCallableオブジェクト
+  * @param args fの引数
+  * @return f(args...)の戻り値型をRとすると、Either<std::variant<Es..., std::exception_ptr>, R>のようなオブジェクト
+  */
+  template<typename... Es>
+    requires (std::same_as<Es, std::remove_cvref_t<Es>> and ...)
+  inline constexpr auto try_catch_as = []<typename F, typename... Args>(F&& f, Args&&... args) noexcept((std::is_nothrow_copy_constructible_v<Es> and ...)) -> monas<sachet<std::variant<Es..., std::exception_ptr>, std::invoke_result_t<F, Args...>>> {
+    using R = std::invoke_result_t<F, Args...>;
+    using either_t = sachet<std::variant<Es..., std::exception_ptr>, R>;
+    using return_t = monas<either_t>;
+
+    auto body = [&] {
+      return return_t(std::in_place, std::in_place_index<1>, std::invoke(std::forward<F>(f), std::forward<Args>(args)...));
+    };
+
+#ifdef HARMONY_NO_EXCEPTIONS
+    return body();
+#else
+    try {
+      if constexpr (sizeof...(Es) == 0) {
+        return body();
+      } else {
+        return detail::invoke_catching_as<sizeof...(Es) - 1, return_t, Es...>(body);
+      }
+    } catch(...) {
+      return return_t(std::in_place, std::in_place_index<0>, std::in_place_index<sizeof...(Es)>, std::current_exception());
+    }
+#endif
+  };
+
+}
+
+namespace harmony::detail {
+
+  template<bool C>
+  concept not_fold = (not C);
+
+  /**
+  * @brief 列の要素型Eの値と、デフォルト構築した要素を末尾に追加できるコンテナ
+  */
+  template<typename C, typename E>
+  concept column_fillable =
+    std::ranges::range<C> and
+    std::default_initializable<C> and
+    std::default_initializable<std::ranges::range_value_t<C>> and
+    std::constructible_from<std::ranges::range_value_t<C>, const E&> and
+    requires(C& c, std::ranges::range_value_t<C> v) {
+      c.insert(std::ranges::end(c), std::move(v));
+    };
+
+  template<typename T, bool IsFold = false>
+  struct map_to_impl {
+
+    template<unwrappable M>
+      requires not_fold<IsFold> and without_narrowing_convertible<traits::unwrap_t<M>, T>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, map_to_impl) noexcept(noexcept(T(*std::move(m)))) -> T {
+      return T(std::move(*m));
+    }
+
+    template<maybe M>
+      requires not_fold<IsFold> and without_narrowing_convertible<traits::unwrap_t<M>, T> and
+               std::default_initializable<T> 
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, map_to_impl) noexcept(noexcept(T(*std::move(m))) and std::is_nothrow_default_constructible_v<T>) -> T {
+      if (m) {
+        return T(std::move(*m));
+      } else {
+        return T{};
+      }
+    }
+
+    /**
+    * @brief listモナドの要素をコンテナTに詰めて返す
+    * @details 要素数が事前に分かる場合は領域を予約してから詰める
+    */
+    template<list M>
+      requires not_fold<IsFold> and
+               (not without_narrowing_convertible<traits::unwrap_t<M>, T>) and
+               std::ranges::range<T> and std::default_initializable<T> and
+               requires(T& c, std::ranges::range_reference_t<M> v) {
+                 c.insert(std::ranges::end(c), std::forward<std::ranges::range_reference_t<M>>(v));
+               }
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, map_to_impl) -> T {
+      auto&& r = *m;
+      T result{};
+
+      if constexpr (std::ranges::sized_range<decltype(r)> and requires(T& c, std::ranges::range_size_t<decltype(r)> n) { c.reserve(n); }) {
+        result.reserve(std::ranges::size(r));
+      }
+
+      for (auto&& v : r) {
+        result.insert(std::ranges::end(result), std::forward<decltype(v)>(v));
+      }
+
+      return result;
+    }
+
+    /**
+    * @brief 列をコンテナTに変換する、無効値の位置にはTの要素型をデフォルト構築した値が入る
+    * @details 要素型がstd::optionalのようなmaybeな型であれば、無効値の位置は無効値になる
+    */
+    template<typename M>
+      requires IsFold and bitmap_column<std::remove_cvref_t<M>> and
+               column_fillable<T, typename std::remove_cvref_t<M>::element_type>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, map_to_impl) -> T {
+      using E = std::ranges::range_value_t<T>;
+
+      const std::remove_reference_t<M>& column = m;
+      const auto values = column.values();
+      T result{};
+
+      if constexpr (requires(T& c, std::size_t n) { c.reserve(n); }) {
+        result.reserve(values.size());
+      }
+
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        if (column.is_valid(i)) {
+          result.insert(std::ranges::end(result), E(values[i]));
+        } else {
+          result.insert(std::ranges::end(result), E{});
+        }
+      }
+
+      return result;
+    }
+
+    template<either M>
+      requires IsFold and
+               without_narrowing_convertible<traits::unwrap_t<M>, T> and
+               without_narrowing_convertible<traits::unwrap_other_t<M>, T>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, map_to_impl) noexcept(noexcept(T(*std::move(m))) and noexcept(T(std::move(m.unwrap_err())))) -> T {
+      if (m) {
+        return T(std::move(*m));
+      } else {
+        return T(std::move(m.unwrap_err()));
+      }
+    }
+  };
+}
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief 有効値を取り出して変換する、有効値を保持しているかのチェックを行わない
+  * @details 縮小変換は禁止
+  * @tparam T 変換先の型
+  */
+  template<typename T>
+    requires (not std::is_reference_v<T>)
+  inline constexpr detail::map_to_impl<T> map_to;
+
+  /**
+  * @brief 有効値及び無効値を取り出して同じ型に変換する
+  * @brief maybeな型が無効値を持つ場合、Tをデフォルト構築して返す
+  * @details 縮小変換は禁止
+  * @tparam T 変換先の型
+  */
+  template<typename T>
+    requires (not std::is_reference_v<T>)
+  inline constexpr detail::map_to_impl<T, true> fold_to;
+
+} // namespace harmony::inline monadic_op
+
+namespace harmony::detail {
+
+  template<typename U>
+  struct value_or_impl {
+    // コピーorムーブして保持
+    U tmp_hold;
+
+    template<maybe M>
+      requires std::convertible_to<U, std::remove_cvref_t<traits::unwrap_t<M>>> and
+               detail::value_or_reusable<U, M>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, value_or_impl&& self) noexcept(noexcept(std::move(m).value_or(std::forward<U>(self.tmp_hold)))) {
+      return std::move(m).value_or(std::move(self.tmp_hold));
+    }
+
+    template<maybe M>
+      requires std::convertible_to<U, std::remove_cvref_t<traits::unwrap_t<M>>>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, value_or_impl&& self) noexcept(noexcept(cpo::validate(m)) and noexcept(cpo::unwrap(m)) and std::is_nothrow_constructible_v<std::remove_cvref_t<traits::unwrap_t<M>>, U>) {
+      using R = std::remove_cvref_t<traits::unwrap_t<M>>;
+
+      if (cpo::validate(m)) {
+        return cpo::unwrap(std::move(m));
+      } else {
+        return R(std::move(self.tmp_hold));
+      }
+    }
+
+    /**
+    * @brief 列の無効値を指定された値で埋めたstd::vectorを返す
+    * @details 全要素が有効なワードはそのままコピーし、それ以外のワードだけ要素毎に選択する
+    */
+    template<typename M>
+      requires bitmap_column<std::remove_cvref_t<M>> and
+               std::convertible_to<U, typename std::remove_cvref_t<M>::element_type> and
+               std::copyable<typename std::remove_cvref_t<M>::element_type>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, value_or_impl&& self) -> std::vector<typename std::remove_cvref_t<M>::element_type> {
+      using E = typename std::remove_cvref_t<M>::element_type;
+
+      const std::remove_reference_t<M>& column = m;
+      const auto values = column.values();
+      const auto words = column.validity_words();
+      const E fill = static_cast<E>(std::move(self.tmp_hold));
+
+      std::vector<E> result(values.begin(), values.end());
+
+      for (std::size_t w = 0; w < words.size(); ++w) {
+        const std::uint64_t bits = words[w];
+        if (bits == ~std::uint64_t(0)) continue;
+
+        const std::size_t first = w * 64;
+        const std::size_t last = std::min(first + 64, values.size());
+
+        for (std::size_t i = first; i < last; ++i) {
+          if (((bits >> (i - first)) & 1) == 0) result[i] = fill;
+        }
+      }
+
+      return result;
+    }
+  };
+
+  template<typename U>
+  value_or_impl(U&&) -> value_or_impl<std::remove_cvref_t<U>>;
+
+
+  template<typename... Args>
+  struct value_or_construct_impl {
+    // チェーンの中でのみ使用されることを想定しているので、ダングリング参照にはならないものとする
+    std::tuple<Args&&...> tmp_hold;
+
+    template<maybe M>
+      requires std::constructible_from<std::remove_cvref_t<traits::unwrap_t<M>>, Args&&...>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, value_or_construct_impl&& self) noexcept(noexcept(cpo::validate(m)) and noexcept(cpo::unwrap(std::move(m))) and std::is_nothrow_constructible_v<std::remove_cvref_t<traits::unwrap_t<M>>, Args&&...>) -> std::remove_cvref_t<traits::unwrap_t<M>> {
+      using R = std::remove_cvref_t<traits::unwrap_t<M>>;
+
+      if (cpo::validate(m)) {
+        return cpo::unwrap(std::move(m));
+      } else {
+        return std::make_from_tuple<R>(std::move(self.tmp_hold));
+      }
+    }
+  };
+
+
+  template<std::invocable F>
+  struct value_or_else_impl {
+    F tmp_f;
+
+    template<maybe M>
+      requires std::convertible_to<std::remove_cvref_t<traits::unwrap_t<M>>, std::invoke_result_t<F>>
+    [[nodiscard]]
+    friend constexpr auto operator|(monas<M>&& m, value_or_else_impl&& self) noexcept(noexcept(cpo::validate(m)) and noexcept(cpo::unwrap(std::move(m))) and std::is_nothrow_invocable_r_v<std::remove_cvref_t<traits::unwrap_t<M>>, std::invoke_result_t<F>>) -> std::remove_cvref_t<traits::unwrap_t<M>> {
+      if (cpo::validate(m)) {
+        return cpo::unwrap(std::move(m));
+      } else {
+        return std::move(self.tmp_f)();
+      }
+    }
+  };
+
+  template<typename F>
+  value_or_else_impl(F&&) -> value_or_else_impl<F>;
+
+} // namespace detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief 有効値を保持していなければ指定された値を返す
+  */
+  inline constexpr auto value_or = []<typename T>(T&& v) {
+    return detail::value_or_impl{ .tmp_hold = std::forward<T>(v) };
+  };
+
+  /**
+  * @brief 有効値を保持していなければ指定された値から構築して返す
+  */
+  inline constexpr auto value_or_construct = []<typename... Args>(Args&&... args) {
+    return detail::value_or_construct_impl<Args...>{ .tmp_hold = std::forward_as_tuple(std::forward<Args>(args)...) };
+  };
+
+  /**
+  * @brief 有効値を保持していなければ指定されたCallableの戻り値を返す
+  */
+  inline constexpr auto value_or_else = []<typename F>(F&& f) {
+    return detail::value_or_else_impl{ .tmp_f = std::forward<F>(f) };
+  };
+
+} // namespace harmony::inline monadic_op
+
+namespace harmony {
+  
+  /**
+  * @brief 有効値と無効値の関係を反転させるラッパークラス
+  * @details このクラスはeitherとなる
+  */
+  template<maybe T>
+  struct abekobe {
+
+    static_assert(not std::is_rvalue_reference_v<T>, "T must not be a rvalue reference type.");
+
+    // lvalueから初期化された際、Tは左辺値参照となる
+    static constexpr bool has_reference = std::is_lvalue_reference_v<T>;
+
+    // Tから参照を外した型、lvalueから初期化された時だけTと異なる
+    using M = std::remove_reference_t<T>;
+
+    T bound;
+
+    /**
+    * @brief 有効値を取得する
+    * @return Tの無効値を返す
+    */
+    [[nodiscard]]
+    constexpr decltype(auto) operator*() noexcept(noexcept(cpo::unwrap_other(bound))) requires either<M> {
+      return cpo::unwrap_other(bound);
+    }
+
+    [[nodiscard]]
+    constexpr decltype(auto) operator*() && noexcept(noexcept(cpo::unwrap_other(std::move(bound)))) requires either<M> and (not has_reference) {
+      return cpo::unwrap_other(std::move(bound));
+    }
+
+    /**
+    * @brief 有効値を取得する
+    * @brief Tがmaybeでしかない時は、無効値としてT自身を返す
+    */
+    [[nodiscard]]
+    constexpr auto operator*() noexcept -> T& {
+      return bound;
+    }
+
+    [[nodiscard]]
+    constexpr auto operator*() && noexcept -> T&& requires (not has_reference) {
+      return std::move(bound);
+    }
+
+    /**
+    * @brief 有効値を保持しているかを判定する
+    * @return Tが有効値を保持していればfalse, そうでないならtrue
+    */
+    [[nodiscard]]
+    constexpr explicit operator bool() const noexcept {
+      return not cpo::validate(bound);
+    }
+
+    /**
+    * @brief 無効値を取得する
+    * @return Tの有効値を返す
+    */
+    [[nodiscard]]
+    constexpr decltype(auto) unwrap_err() noexcept(noexcept(cpo::unwrap(bound))) {
+      return cpo::unwrap(bound);
+    }
+
+    [[nodiscard]]
+    constexpr decltype(auto) unwrap_err() && noexcept(noexcept(cpo::unwrap(std::move(bound)))) requires (not has_reference) {
+      return cpo::unwrap(std::move(bound));
+    }
+
+  };
+
+  template<maybe T>
+    requires std::is_lvalue_reference_v<T>
+  abekobe(T&) -> abekobe<T&>;
+
+  template<maybe T>
+  abekobe(T&&) -> abekobe<std::remove_cv_t<T>>;
+
+  /**
+  * @brief 有効値と無効値を反転させる
+  * @return abekobe<M>をmonasでラップしたオブジェクト
+  */
+  inline constexpr auto invert = []<maybe M>(M &&m) {
+    return monas<abekobe<M>>(std::in_place, std::forward<M>(m));
+  };
+}
+
+namespace harmony {
+  namespace detail {
+
+    struct harmonize_impl {
+
+      /**
+      * @brief maybeでないような型のオブジェクトをeitherとして扱えるようにする
+      * @param value 変換する値
+      * @param check_invalid 無効値を判定する述語オブジェクト
+      * @return valueが無効値なら無効状態、そうでないなら有効状態を保持したeitherなオブジェクトをmonasでラップしたものを返す
+      */
+      template<typename T, std::predicate<T> P>
+        requires (not either<T>)
+      [[nodiscard]]
+      constexpr specialization_of<monas> auto operator()(T&& value, P&& check_invalid) const {
+        using RC = std::remove_cvref_t<T>;
+        using either_t = sachet<RC, RC>;
+        using return_t = monas<either_t>;
+
+        if (not check_invalid(value)) {
+          // 有効値として構築
+          return return_t(std::in_place, std::in_place_index<1>, std::forward<T>(value));
+        } else {
+          // 無効値として構築
+          return return_t(std::in_place, std::in_place_index<0>, std::forward<T>(value));
+        }
+      }
+
+      /**
+      * @brief maybeでないような型のオブジェクトをeitherとして扱えるようにする
+      * @param value 変換する値
+      * @param invalid 無効値として扱うTの値
+      * @return valueが無効値なら無効状態、そうでないなら有効状態を保持したeitherなオブジェクトをmonasでラップしたものを返す
+      */
+      template<typename T, std::equality_comparable_with<T> U = T>
+        requires (not either<T>)
+      [[nodiscard]]
+      constexpr specialization_of<monas> auto operator()(T&& value, U&& invalid) const {
+        return (*this)(std::forward<T>(value), [invalid_value = std::forward<U>(invalid)](const auto& comp_value) -> bool {
+          return invalid_value == comp_value; // 値が無効値である場合にtrueを返す
+        });
+      }
+
+      /**
+      * @brief boolをeitherとして扱えるようにする
+      * @param value 変換するbool値
+      * @return either<bool, bool>、valueがfalseなら無効状態、trueなら有効状態となるeitherなオブジェクトをmonasでラップしたものを返す
+      */
+      [[nodiscard]]
+      constexpr specialization_of<monas> auto operator()(bool value) const {
+        return (*this)(value, false);
+      }
+
+      /**
+      * @brief 浮動小数点数型をeitherとして扱えるようにする
+      * @param value 変換する浮動小数値
+      * @return either<FP, FP>、valueがNaNなら無効状態、そうでないなら有効状態となるeitherなオブジェクトをmonasでラップしたものを返す
+      */
+      template<std::floating_point FP>
+      [[nodiscard]]
+      constexpr specialization_of<monas> auto operator()(FP value) const {
+        return (*this)(value, [](FP f) { return std::isnan(f); });
+      }
+
+    };
+  } // namespace detail
+
+  /**
+  * @brief maybeでないような型のオブジェクトをeitherとして扱えるようにする
+  * @details 返されるオブジェクトには渡されたvalueを完全転送する（適切にコピー/ムーブし、参照のままにしない）
+  */
+  inline constexpr detail::harmonize_impl harmonize{};
+
+  inline constexpr auto& to_either = harmonize;
+
+} // namespace harmony
+
+
+namespace harmony {
+  namespace detail {
+
+    template<typename T>
+    constexpr auto lvalue_as_const(T& t) -> std::add_const_t<T>& {
+      return std::as_const(t);
+    }
+
+    template<typename T>
+    constexpr auto lvalue_as_const(T&& t) -> T&& {
+      return std::forward<T>(t);
+    }
+
+    template<typename T>
+    using lvalue_as_const_t = decltype(lvalue_as_const(std::declval<T>()));
+
+    template<typename F>
+    struct inspect_impl {
+      F ins_f;
+
+      template<unwrappable M>
+        requires std::invocable<F, lvalue_as_const_t<traits::unwrap_t<M>>> and
+                 std::same_as<std::invoke_result_t<F, lvalue_as_const_t<traits::unwrap_t<M>>>, void>
+      friend constexpr auto operator|(monas<M>&& m, inspect_impl&& self) -> monas<M>&& {
+        std::invoke(std::move(self.ins_f), lvalue_as_const(cpo::unwrap(m)));
+        return std::move(m);
+      }
+
+      template<maybe M>
+        requires std::invocable<F, lvalue_as_const_t<traits::unwrap_t<M>>> and
+                 std::same_as<std::invoke_result_t<F, lvalue_as_const_t<traits::unwrap_t<M>>>, void>
+      friend constexpr auto operator|(monas<M>&& m, inspect_impl&& self) -> monas<M>&& {
+        if (cpo::validate(m)) {
+          std::invoke(std::move(self.ins_f), lvalue_as_const(cpo::unwrap(m)));
+        }
+        return std::move(m);
+      }
+    };
+
+    template<typename F>
+    inspect_impl(F&&) -> inspect_impl<F>;
+
+
+    template<typename F>
+    struct inspect_err_impl {
+      F ins_f;
+
+      template<maybe M>
+        requires std::invocable<F, lvalue_as_const_t<traits::unwrap_other_t<M>>> and
+                 std::same_as<std::invoke_result_t<F, lvalue_as_const_t<traits::unwrap_other_t<M>>>, void>
+      friend constexpr auto operator|(monas<M>&& m, inspect_err_impl&& self) -> monas<M>&& {
+        if (not cpo::validate(m)) {
+          std::invoke(std::move(self.ins_f), lvalue_as_const(cpo::unwrap_other(m)));
+        }
+        return std::move(m);
+      }
+    };
+
+    template<typename F>
+    inspect_err_impl(F&&) -> inspect_err_impl<F>;
+  }
+
+  inline constexpr auto inspect = []<typename F>(F&& f) {
+    return detail::inspect_impl{ .ins_f = std::forward<F>(f) };
+  };
+
+  inline constexpr auto inspect_err = []<typename F>(F&& f) {
+    return detail::inspect_err_impl{ .ins_f = std::forward<F>(f) };
+  };
+}
+
+namespace harmony {
+
+  /**
+  * @brief トレースされたチェーンの1ステージ分の記録
+  */
+  struct trace_event {
+    // チェーンの先頭を0とするステージ番号
+    std::size_t stage;
+    // ステージの処理にかかった時間
+    std::chrono::nanoseconds elapsed;
+    // ステージに渡した処理が呼ばれなかった（値側の処理は入力が無効値の時、or_elseなどのエラー側の処理は入力が有効値の時）
+    bool short_circuited;
+    // ステージの入力が有効値を保持していたか
+    bool input_valid;
+    // ステージの出力が有効値を保持しているか（maybeでない場合は常にtrue）
+    bool valid;
+  };
+
+  /**
+  * @brief トレースのポリシー、enabledがfalseならトレースのためのコードは一切生成されない
+  * @details enabledがtrueの場合、ステージ毎にrecord(const trace_event&)が呼ばれる。
+  * static constexpr bool timed = falseを持つポリシーでは時間を計測せず、elapsedは常に0になる
+  */
+  template<typename P>
+  concept trace_policy =
+    requires {
+      { std::bool_constant<P::enabled>{} } -> std::convertible_to<bool>;
+    } and
+    (not P::enabled or requires(P& p, const trace_event& e) { p.record(e); });
+
+  /**
+  * @brief 何も記録しないトレースポリシー
+  */
+  struct no_trace {
+    static constexpr bool enabled = false;
+  };
+
+  /**
+  * @brief トレースの記録をstd::vectorに溜めていくトレースポリシー
+  */
+  class trace_recorder {
+    std::vector<trace_event> m_events;
+
+  public:
+    static constexpr bool enabled = true;
+
+    void record(const trace_event& e) {
+      m_events.push_back(e);
+    }
+
+    [[nodiscard]]
+    auto events() const noexcept -> std::span<const trace_event> {
+      return m_events;
+    }
+
+    /**
+    * @brief 有効値を無効値に変えた（失敗した）最初のステージを探す
+    */
+    [[nodiscard]]
+    auto failed_stage() const noexcept -> std::optional<std::size_t> {
+      for (const auto& e : m_events) {
+        if (e.input_valid and not e.valid) return e.stage;
+      }
+      return std::nullopt;
+    }
+
+    void clear() noexcept {
+      m_events.clear();
+    }
+  };
+
+  template<typename T, trace_policy Policy>
+  class traced;
+
+  namespace detail {
+
+    /**
+    * @brief トレース中のチェーンの状態、ポリシーが無効な場合は空
+    */
+    template<typename Policy, bool = Policy::enabled>
+    struct trace_state {
+      Policy* policy;
+      std::size_t stage = 0;
+    };
+
+    template<typename Policy>
+    struct trace_state<Policy, false> {};
+
+    template<typename Policy>
+    inline constexpr bool trace_timed = true;
+
+    template<typename Policy>
+      requires requires { { std::bool_constant<Policy::timed>{} } -> std::convertible_to<bool>; }
+    inline constexpr bool trace_timed<Policy> = Policy::timed;
+
+    template<bool Timed>
+    struct trace_clock {
+      std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+      auto elapsed() const -> std::chrono::nanoseconds {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      }
+    };
+
+    template<>
+    struct trace_clock<false> {
+      constexpr auto elapsed() const noexcept -> std::chrono::nanoseconds {
+        return std::chrono::nanoseconds{0};
+      }
+    };
+
+    template<typename M>
+    constexpr bool trace_validity(const M& m) noexcept(noexcept(bool(m))) {
+      if constexpr (requires { bool(m); }) {
+        return bool(m);
+      } else {
+        return true;
+      }
+    }
+
+    /**
+    * @brief ステージの処理がどちらの値に対して呼ばれるか
+    */
+    enum class trace_side {
+      // 有効値の時だけ呼ぶ（bind、map、and_thenなど）
+      value,
+      // 無効値の時だけ呼ぶ（map_err、or_elseなど）
+      error,
+      // どちらでも呼ぶ（match、value_orなど終端の操作）
+      both
+    };
+
+    template<typename Op>
+    inline constexpr trace_side trace_side_of = trace_side::value;
+
+    template<typename F>
+    inline constexpr trace_side trace_side_of<map_err_impl<F>> = trace_side::error;
+
+    template<typename F>
+    inline constexpr trace_side trace_side_of<or_else_impl<F>> = trace_side::error;
+
+    template<typename F>
+    inline constexpr trace_side trace_side_of<inspect_err_impl<F>> = trace_side::error;
+
+    template<typename F>
+    inline constexpr trace_side trace_side_of<value_or_else_impl<F>> = trace_side::error;
+
+    template<typename Fok, typename Ferr>
+    inline constexpr trace_side trace_side_of<match_impl<Fok, Ferr>> = trace_side::both;
+
+    template<typename U>
+    inline constexpr trace_side trace_side_of<value_or_impl<U>> = trace_side::both;
+
+    /**
+    * @brief 入力の有効性から、ステージの処理が呼ばれなかったかを求める
+    */
+    template<typename Op>
+    constexpr bool trace_short_circuited(bool input_valid) noexcept {
+      switch (trace_side_of<std::remove_cvref_t<Op>>) {
+        case trace_side::value: return not input_valid;
+        case trace_side::error: return input_valid;
+        default: return false;
+      }
+    }
+  }
+
+  /**
+  * @brief 各ステージの記録をポリシーに渡しながらチェーンを進めるmonasのラッパー
+  * @details operator|は保持するmonasにそのまま転送され、結果がmonasならtracedで包み直して次のステージに進む。
+  * 結果がmonasでない（value_orなどの終端の操作）ならそれをそのまま返す。ポリシーが無効な場合はmonasのチェーンと同じコードになる
+  * @tparam T monas<T>のT
+  * @tparam Policy トレースポリシー
+  */
+  template<typename T, trace_policy Policy>
+  class traced {
+    monas<T> m_monas;
+    [[no_unique_address]] detail::trace_state<Policy> m_state;
+
+    template<typename, trace_policy>
+    friend class traced;
+
+  public:
+
+    constexpr traced(monas<T>&& m, detail::trace_state<Policy> state) noexcept(std::is_nothrow_move_constructible_v<monas<T>>)
+      : m_monas(std::move(m))
+      , m_state(state)
+    {}
+
+    /**
+    * @brief 保持するmonasを取り出す
+    */
+    [[nodiscard]]
+    constexpr auto untraced() && noexcept -> monas<T>&& {
+      return std::move(m_monas);
+    }
+
+    /**
+    * @brief 次のステージを適用する
+    */
+    template<typename Op>
+      requires requires(monas<T>&& m, Op&& op) { std::move(m) | std::forward<Op>(op); }
+    friend constexpr auto operator|(traced&& self, Op&& op) {
+      using result_t = decltype(std::move(self.m_monas) | std::forward<Op>(op));
+      using R = std::remove_cvref_t<result_t>;
+
+      if constexpr (not Policy::enabled) {
+        if constexpr (specialization_of<R, monas>) {
+          return traced<traits::monas_arg_t<R>, Policy>(std::move(self.m_monas) | std::forward<Op>(op), {});
+        } else {
+          return R(std::move(self.m_monas) | std::forward<Op>(op));
+        }
+      } else {
+        const bool valid_before = detail::trace_validity(self.m_monas);
+        const detail::trace_clock<detail::trace_timed<Policy>> clock{};
+
+        auto record = [&](bool valid_after) {
+          self.m_state.policy->record(trace_event{
+            .stage = self.m_state.stage,
+            .elapsed = clock.elapsed(),
+            .short_circuited = detail::trace_short_circuited<Op>(valid_before),
+            .input_valid = valid_before,
+            .valid = valid_after
+          });
+        };
+
+        if constexpr (specialization_of<R, monas>) {
+          monas<traits::monas_arg_t<R>> next = std::move(self.m_monas) | std::forward<Op>(op);
+          record(detail::trace_validity(next));
+
+          return traced<traits::monas_arg_t<R>, Policy>(std::move(next), { self.m_state.policy, self.m_state.stage + 1 });
+        } else {
+          R result = std::move(self.m_monas) | std::forward<Op>(op);
+          record(valid_before);
+
+          return result;
+        }
+      }
+    }
+  };
+
+  namespace detail {
+
+    struct trace_fn {
+
+      /**
+      * @brief ポリシーを指定してトレースを開始する
+      * @param m monasで包むモナド的な値（monasでもよい）
+      * @param policy トレースポリシー、チェーンの評価が終わるまで生存している必要がある
+      */
+      template<typename M, trace_policy Policy>
+      [[nodiscard]]
+      constexpr auto operator()(M&& m, Policy& policy) const {
+        auto wrapped = monas(std::forward<M>(m));
+        using T = traits::monas_arg_t<decltype(wrapped)>;
+
+        if constexpr (Policy::enabled) {
+          return traced<T, Policy>(std::move(wrapped), { &policy, 0 });
+        } else {
+          return traced<T, Policy>(std::move(wrapped), {});
+        }
+      }
+
+      /**
+      * @brief 何も記録しないトレース、monasと同じように振る舞う
+      */
+      template<typename M>
+      [[nodiscard]]
+      constexpr auto operator()(M&& m) const {
+        no_trace policy{};
+        return (*this)(std::forward<M>(m), policy);
+      }
+    };
+  }
+
+  /**
+  * @brief monasのチェーンの各ステージの番号・所要時間・短絡したかどうかをポリシーに記録する
+  */
+  inline constexpr detail::trace_fn trace{};
+
+} // namespace harmony
+
+#ifdef __cpp_lib_source_location
+
+namespace harmony {
+
+  /**
+  * @brief funnelで数えるステージ数の上限、これ以降のステージは最後のステージに合算される
+  */
+  inline constexpr std::size_t funnel_max_stages = 16;
+
+  /**
+  * @brief 呼び出し箇所の1ステージ分の集計
+  */
+  struct funnel_stage {
+    // 有効値を受け取ってステージの処理を呼んだ回数
+    std::uint64_t reached;
+    // 有効値を受け取って無効値を返した（validateが最初にfalseになった）回数
+    std::uint64_t failed;
+  };
+
+  /**
+  * @brief 呼び出し箇所毎の集計
+  */
+  struct funnel_site_report {
+    const char* file;
+    const char* function;
+    std::uint_least32_t line;
+    std::uint_least32_t column;
+    // チェーンを開始した回数、entered - stages[0].reachedが最初から無効値だった入力の数
+    std::uint64_t entered;
+    // 一度も到達していない末尾のステージは含まない
+    std::vector<funnel_stage> stages;
+  };
+
+  namespace detail {
+
+    struct funnel_site;
+
+    /**
+    * @brief スレッド毎・呼び出し箇所毎のカウンタ、funnelのトレースポリシーとしても使用する
+    * @details 書き込むのは所有するスレッドだけなので、インクリメントはrelaxedなload/storeで行う。
+    * 集計は他のスレッドからrelaxedに読み出す。スレッドの終了後も集計できるように解放せず、終了したスレッドの分は後から開始したスレッドが引き継いで加算する
+    */
+    struct funnel_counters {
+      static constexpr bool enabled = true;
+      static constexpr bool timed = false;
+
+      std::atomic<std::uint64_t> entered{0};
+      std::atomic<std::uint64_t> reached[funnel_max_stages]{};
+      std::atomic<std::uint64_t> failed[funnel_max_stages]{};
+      funnel_counters* next = nullptr;
+
+      static void increment(std::atomic<std::uint64_t>& c) noexcept {
+        c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+      }
+
+      void record(const trace_event& e) noexcept {
+        // 有効値が到達したステージだけを数える
+        if (not e.input_valid) return;
+
+        const std::size_t stage = std::min(e.stage, funnel_max_stages - 1);
+        increment(reached[stage]);
+        if (not e.valid) increment(failed[stage]);
+      }
+    };
+
+    /**
+    * @brief 呼び出し箇所、スレッド毎のカウンタをロックフリーなリストで保持する
+    * @details 終了したスレッドのカウンタはfree_countersに戻され、次にこの箇所を初めて通るスレッドが再利用する
+    */
+    struct funnel_site {
+      const char* file;
+      const char* function;
+      std::uint_least32_t line;
+      std::uint_least32_t column;
+      std::atomic<funnel_counters*> counters{nullptr};
+      funnel_site* next = nullptr;
+      std::mutex free_mutex{};
+      std::vector<funnel_counters*> free_counters{};
+
+      /**
+      * @brief 終了したスレッドが使っていたカウンタを得る、なければ新しく作ってリストに追加する
+      */
+      auto acquire_counters() -> funnel_counters* {
+        {
+          std::lock_guard lock{free_mutex};
+          if (not free_counters.empty()) {
+            funnel_counters* reused = free_counters.back();
+            free_counters.pop_back();
+            return reused;
+          }
+        }
+
+        auto* created = new funnel_counters{};
+
+        funnel_counters* head = counters.load(std::memory_order_relaxed);
+        do {
+          created->next = head;
+        } while (not counters.compare_exchange_weak(head, created, std::memory_order_release, std::memory_order_relaxed));
+
+        return created;
+      }
+
+      /**
+      * @brief スレッドの終了時に、そのスレッドのカウンタを再利用できるように戻す、値はリセットしない
+      */
+      void release_counters(funnel_counters* c) {
+        std::lock_guard lock{free_mutex};
+        free_counters.push_back(c);
+      }
+
+      bool same_location(const std::source_location& loc) const noexcept {
+        return line == loc.line() and column == loc.column() and
+               std::string_view(file) == loc.file_name() and
+               std::string_view(function) == loc.function_name();
+      }
+    };
+
+    /**
+    * @brief 全ての呼び出し箇所のロックフリーなリスト、要素は追加されるだけで削除されない
+    */
+    inline std::atomic<funnel_site*> funnel_registry{nullptr};
+
+    /**
+    * @brief 呼び出し箇所を登録済みのものから探し、なければ登録する
+    * @details CASに失敗した場合は、その間に追加された箇所だけを探し直すため、同じ箇所が重複して登録されることはない
+    */
+    inline auto funnel_find_or_register(const std::source_location& loc) -> funnel_site* {
+      funnel_site* head = funnel_registry.load(std::memory_order_acquire);
+      funnel_site* searched_until = nullptr;
+      funnel_site* created = nullptr;
+
+      while (true) {
+        for (funnel_site* p = head; p != searched_until; p = p->next) {
+          if (p->same_location(loc)) {
+            delete created;
+            return p;
+          }
+        }
+
+        if (created == nullptr) {
+          created = new funnel_site{ .file = loc.file_name(), .function = loc.function_name(), .line = loc.line(), .column = loc.column() };
+        }
+
+        searched_until = head;
+        created->next = head;
+        if (funnel_registry.compare_exchange_weak(head, created, std::memory_order_release, std::memory_order_acquire)) {
+          return created;
+        }
+      }
+    }
+
+    /**
+    * @brief このスレッドの、呼び出し箇所に対応するカウンタを得る
+    * @details 呼び出し箇所の数は少ないことを想定し、スレッド毎のキャッシュを線形探索する。初めての箇所の場合だけ登録を行う。
+    * キャッシュのキーはfunnel_site::same_location()と同じく関数名を含むため、関数テンプレート内の呼び出しはインスタンス毎に数えられる
+    */
+    inline auto funnel_local_counters(const std::source_location& loc) -> funnel_counters& {
+      struct entry {
+        const char* file;
+        const char* function;
+        std::uint_least32_t line;
+        std::uint_least32_t column;
+        funnel_site* site;
+        funnel_counters* counters;
+      };
+
+      struct local_cache {
+        std::vector<entry> entries;
+
+        ~local_cache() {
+          for (const auto& e : entries) {
+            e.site->release_counters(e.counters);
+          }
+        }
+      };
+      thread_local local_cache cache;
+
+      // 同じ箇所のsource_locationは同じ文字列リテラルを指すため、ここではポインタで比較する
+      for (const auto& e : cache.entries) {
+        if (e.line == loc.line() and e.column == loc.column() and e.file == loc.file_name() and e.function == loc.function_name()) {
+          return *e.counters;
+        }
+      }
+
+      funnel_site* site = funnel_find_or_register(loc);
+      funnel_counters* counters = site->acquire_counters();
+
+      cache.entries.push_back({ loc.file_name(), loc.function_name(), loc.line(), loc.column(), site, counters });
+      return *counters;
+    }
+
+    struct funnel_fn {
+
+      /**
+      * @brief 呼び出し箇所毎にステージ毎の到達数と失敗数を数えながら、monasのチェーンを開始する
+      * @param m monasで包むモナド的な値（monasでもよい）
+      * @param loc 呼び出し箇所、通常は指定しない
+      */
+      template<typename M>
+      [[nodiscard]]
+      auto operator()(M&& m, const std::source_location& loc = std::source_location::current()) const {
+        funnel_counters& counters = funnel_local_counters(loc);
+        funnel_counters::increment(counters.entered);
+
+        return trace_fn{}(std::forward<M>(m), counters);
+      }
+    };
+
+    /**
+    * @brief Prometheusのexposition形式のラベル値として、バックスラッシュ・ダブルクォート・改行をエスケープしてoutに追加する
+    */
+    inline void append_label_value(std::string& out, std::string_view value) {
+      for (char c : value) {
+        switch (c) {
+        case '\\': out += "\\\\"; break;
+        case '"': out += "\\\""; break;
+        case '\n': out += "\\n"; break;
+        default: out += c; break;
+        }
+      }
+    }
+  }
+
+  /**
+  * @brief 呼び出し箇所毎に、各ステージに到達した入力の数と、最初に無効値になったステージを数えるトレース
+  * @details ホットパスで行うのはスレッドローカルなカウンタのインクリメントだけ、集計はfunnel_report()で行う
+  */
+  inline constexpr detail::funnel_fn funnel{};
+
+  /**
+  * @brief 全ての呼び出し箇所について、全てのスレッドのカウンタを集計する
+  * @details ロックを取らずにカウンタを読むため、実行中のチェーンの分が一部だけ反映されることがある
+  */
+  inline auto funnel_report() -> std::vector<funnel_site_report> {
+    std::vector<funnel_site_report> reports;
+
+    for (auto* site = detail::funnel_registry.load(std::memory_order_acquire); site != nullptr; site = site->next) {
+      funnel_site_report report{ .file = site->file, .function = site->function, .line = site->line, .column = site->column, .entered = 0, .stages = {} };
+      std::array<funnel_stage, funnel_max_stages> stages{};
+
+      for (auto* c = site->counters.load(std::memory_order_acquire); c != nullptr; c = c->next) {
+        report.entered += c->entered.load(std::memory_order_relaxed);
+        for (std::size_t i = 0; i < funnel_max_stages; ++i) {
+          stages[i].reached += c->reached[i].load(std::memory_order_relaxed);
+          stages[i].failed += c->failed[i].load(std::memory_order_relaxed);
+        }
+      }
+
+      std::size_t used = funnel_max_stages;
+      while (used != 0 and stages[used - 1].reached == 0) --used;
+      report.stages.assign(stages.begin(), stages.begin() + used);
+
+      reports.push_back(std::move(report));
+    }
+
+    return reports;
+  }
+
+  /**
+  * @brief funnel_report()の結果を、1行に1つの値を持つテキスト形式（Prometheusのexposition形式）で出力する
+  * @details メトリクス毎に# TYPE行に続けて全ての呼び出し箇所の値をまとめて出力する
+  */
+  inline auto funnel_dump() -> std::string {
+    const auto reports = funnel_report();
+
+    std::vector<std::string> sites;
+    sites.reserve(reports.size());
+    for (const auto& r : reports) {
+      std::string site = "site=\"";
+      detail::append_label_value(site, r.file);
+      site += ":" + std::to_string(r.line) + ":" + std::to_string(r.column) + "\"";
+      sites.push_back(std::move(site));
+    }
+
+    std::string out = "# TYPE harmony_funnel_entered counter\n";
+    for (std::size_t n = 0; n < reports.size(); ++n) {
+      out += "harmony_funnel_entered{" + sites[n] + "} " + std::to_string(reports[n].entered) + "\n";
+    }
+
+    auto dump_stages = [&](const char* name, std::uint64_t funnel_stage::* count) {
+      out += std::string("# TYPE ") + name + " counter\n";
+      for (std::size_t n = 0; n < reports.size(); ++n) {
+        for (std::size_t i = 0; i < reports[n].stages.size(); ++i) {
+          out += std::string(name) + "{" + sites[n] + ",stage=\"" + std::to_string(i) + "\"} " + std::to_string(reports[n].stages[i].*count) + "\n";
+        }
+      }
+    };
+    dump_stages("harmony_funnel_reached", &funnel_stage::reached);
+    dump_stages("harmony_funnel_failed", &funnel_stage::failed);
+
+    return out;
+  }
+
+} // namespace harmony
+
+#endif // __cpp_lib_source_location
+
+
+namespace harmony {
+
+  /**
+  * @brief 渡された処理を新しいスレッドで実行するexecutor
+  * @details 呼び出し毎にスレッドを1つ起動してdetachする。スレッドはjoinされないため、処理がmain()の終了より後まで残らないようにするのは利用者の責任
+  */
+  struct new_thread_executor {
+    template<std::invocable F>
+    void execute(F&& f) const {
+      std::thread(std::forward<F>(f)).detach();
+    }
+  };
+
+  /**
+  * @brief 渡された処理をその場で実行するexecutor
+  */
+  struct inline_executor {
+    template<std::invocable F>
+    void execute(F&& f) const {
+      std::invoke(std::forward<F>(f));
+    }
+  };
+
+} // namespace harmony
+
+namespace harmony::detail {
+
+  /**
+  * @brief ムーブのみ可能な、引数なしのCallableを型消去して保持する
+  */
+  class pool_task {
+
+    struct task_base {
+      virtual ~task_base() = default;
+      virtual void run() = 0;
+    };
+
+    template<typename F>
+    struct task_holder final : task_base {
+      F f;
+
+      explicit task_holder(F&& fn) : f(std::move(fn)) {}
+
+      void run() override {
+        std::invoke(f);
+      }
+    };
+
+    std::unique_ptr<task_base> m_task;
+
+  public:
+
+    pool_task() = default;
+
+    template<typename F>
+      requires (not std::same_as<std::remove_cvref_t<F>, pool_task>) and std::invocable<std::decay_t<F>&>
+    explicit pool_task(F&& f)
+      : m_task(std::make_unique<task_holder<std::decay_t<F>>>(std::decay_t<F>(std::forward<F>(f))))
+    {}
+
+    explicit operator bool() const noexcept {
+      return bool(m_task);
+    }
+
+    void operator()() {
+      m_task->run();
+    }
+  };
+
+} // namespace harmony::detail
+
+namespace harmony {
+
+  /**
+  * @brief ワーカーごとのキューを持ち、暇なワーカーが他のキューから処理を盗むスレッドプール
+  * @details ワーカー上から投げられた処理はそのワーカーのキューの末尾に積まれ、LIFOで処理される（キャッシュ局所性のため）
+  * @details 外部から投げられた処理はラウンドロビンで各キューに振り分けられる。盗む側はキューの先頭（古い処理）から取る
+  * @details 処理のない間ワーカーはcondition_variableで待機し、スピンはしない
+  * @details デストラクタはキューに残った処理を全て実行し終えてからワーカーを終了する。処理から送出された例外はstd::terminateを呼ぶ
+  */
+  class thread_pool {
+
+    struct worker_queue {
+      std::mutex mtx;
+      std::deque<detail::pool_task> tasks;
+    };
+
+    std::vector<std::unique_ptr<worker_queue>> m_queues;
+    std::atomic<std::size_t> m_pending = 0;
+    std::atomic<std::size_t> m_next = 0;
+    std::mutex m_sleep_mtx;
+    std::condition_variable m_wakeup;
+    bool m_stop = false;
+    std::vector<std::jthread> m_workers;
+
+    // 現在のスレッドがワーカーであるプールとそのキューの番号
+    inline static thread_local const thread_pool* tls_owner = nullptr;
+    inline static thread_local std::size_t tls_index = 0;
+
+    auto try_pop(std::size_t index) -> detail::pool_task {
+      // 自分のキューは末尾から
+      {
+        auto& q = *m_queues[index];
+        std::lock_guard lock{q.mtx};
+        if (not q.tasks.empty()) {
+          auto task = std::move(q.tasks.back());
+          q.tasks.pop_back();
+          return task;
+        }
+      }
+
+      // 他のキューからは先頭から盗む
+      const std::size_t n = m_queues.size();
+      for (std::size_t k = 1; k < n; ++k) {
+        auto& q = *m_queues[(index + k) % n];
+        std::lock_guard lock{q.mtx};
+        if (not q.tasks.empty()) {
+          auto task = std::move(q.tasks.front());
+          q.tasks.pop_front();
+          return task;
+        }
+      }
+
+      return {};
+    }
+
+    void worker_loop(std::size_t index) {
+      tls_owner = this;
+      tls_index = index;
+
+      while (true) {
+        if (auto task = try_pop(index)) {
+          m_pending.fetch_sub(1, std::memory_order_relaxed);
+          task();
+          continue;
+        }
+
+        std::unique_lock lock{m_sleep_mtx};
+        m_wakeup.wait(lock, [this] { return m_stop or 0 < m_pending.load(std::memory_order_relaxed); });
+
+        if (m_stop and m_pending.load(std::memory_order_relaxed) == 0) {
+          return;
+        }
+      }
+    }
+
+  public:
+
+    /**
+    * @param workers ワーカースレッド数、0の場合はハードウェアのスレッド数
+    */
+    explicit thread_pool(std::size_t workers = 0) {
+      if (workers == 0) {
+        workers = detail::hardware_workers();
+      }
+
+      m_queues.reserve(workers);
+      for (std::size_t i = 0; i < workers; ++i) {
+        m_queues.push_back(std::make_unique<worker_queue>());
+      }
+
+      m_workers.reserve(workers);
+      for (std::size_t i = 0; i < workers; ++i) {
+        m_workers.emplace_back([this, i] { worker_loop(i); });
+      }
+    }
+
+    thread_pool(const thread_pool&) = delete;
+    thread_pool& operator=(const thread_pool&) = delete;
+
+    ~thread_pool() {
+      {
+        std::lock_guard lock{m_sleep_mtx};
+        m_stop = true;
+      }
+      m_wakeup.notify_all();
+      // jthreadのデストラクタで全ワーカーの終了を待機
+      m_workers.clear();
+    }
+
+    /**
+    * @brief 処理をキューに積む、呼び出しはブロックしない
+    */
+    template<std::invocable F>
+    void execute(F&& f) {
+      const std::size_t index = tls_owner == this ? tls_index : m_next.fetch_add(1, std::memory_order_relaxed) % m_queues.size();
+
+      // ワーカーが積んだ直後の処理を取り出してもm_pendingが0を下回らないように、積む前に数える
+      m_pending.fetch_add(1, std::memory_order_relaxed);
+      {
+        auto& q = *m_queues[index];
+        std::lock_guard lock{q.mtx};
+#ifdef HARMONY_NO_EXCEPTIONS
+        q.tasks.emplace_back(std::forward<F>(f));
+#else
+        try {
+          q.tasks.emplace_back(std::forward<F>(f));
+        } catch (...) {
+          m_pending.fetch_sub(1, std::memory_order_relaxed);
+          throw;
+        }
+#endif
+      }
+
+      // 待機に入ろうとしているワーカーが通知を取りこぼさないように、一度ロックを通過してから通知する
+      { std::lock_guard lock{m_sleep_mtx}; }
+      m_wakeup.notify_one();
+    }
+
+    /**
+    * @brief ワーカースレッド数
+    */
+    auto size() const noexcept -> std::size_t {
+      return m_queues.size();
+    }
+  };
+
+} // namespace harmony
+
+namespace harmony::detail {
+
+  /**
+  * @brief executorを指定しない並列処理が使用する、プロセスで共有するthread_pool
+  * @details 最初に使用された時に、ハードウェアのスレッド数のワーカーで構築される
+  */
+  inline auto shared_pool() -> thread_pool& {
+    static thread_pool pool;
+    return pool;
+  }
+
+  inline void parallel_executor_ref::submit(std::shared_ptr<parallel_job> job) const {
+    if (m_exec == nullptr) {
+      shared_pool().execute([job = std::move(job)] { job->work(); });
+    } else {
+      m_submit(m_exec, std::move(job));
+    }
+  }
+
+} // namespace harmony::detail
+
+namespace harmony::detail {
+
+  /**
+  * @brief 処理をチェーンの前から順番に適用する
+  * @details 途中の結果は一時オブジェクトなので、最終結果は値で返す
+  */
+  template<typename M>
+  constexpr auto apply_ops(M&& m) -> std::remove_cvref_t<M> {
+    return std::forward<M>(m);
+  }
+
+  template<typename M, typename Op, typename... Ops>
+  constexpr auto apply_ops(M&& m, Op&& op, Ops&&... ops) {
+    return apply_ops(std::forward<M>(m) | std::forward<Op>(op), std::forward<Ops>(ops)...);
+  }
+
+  /**
+  * @brief チェーンの結果がmonasならば、保持するモナド的な型のオブジェクトを取り出す
+  */
+  template<typename R>
+  constexpr auto unwrap_monas(R&& r) {
+    if constexpr (specialization_of<std::remove_cvref_t<R>, monas>) {
+      return traits::monas_value_t<std::remove_cvref_t<R>>(std::move(r));
+    } else {
+      return std::remove_cvref_t<R>(std::forward<R>(r));
+    }
+  }
+
+  template<future_like F, typename... Ops>
+  using deferred_result_t = decltype(unwrap_monas(apply_ops(monas(cpo::unwrap(std::declval<F>())), std::declval<Ops>()...)));
+
+  struct to_future_impl {};
+
+  /**
+  * @brief future-likeな型に対する処理を、値の準備ができた後にexecutor上で実行するように保持するmonas
+  * @tparam F future-likeな型
+  * @tparam E executorの型、左辺値から構築された場合は参照
+  * @tparam Ops 後から適用する処理の型
+  */
+  template<future_like F, typename E, typename... Ops>
+  class deferred_monas {
+
+    F m_future;
+    E m_executor;
+    std::tuple<Ops...> m_ops;
+
+    template<future_like, typename, typename...>
+    friend class deferred_monas;
+
+  public:
+
+    constexpr deferred_monas(F&& future, E&& exec, std::tuple<Ops...>&& ops)
+      : m_future(std::move(future))
+      , m_executor(std::forward<E>(exec))
+      , m_ops(std::move(ops))
+    {}
+
+    /**
+    * @brief 処理をチェーンの末尾に追加する、この時点では何も実行されない
+    */
+    template<typename Op>
+      requires requires { typename deferred_result_t<F, Ops..., std::remove_cvref_t<Op>>; }
+    friend auto operator|(deferred_monas&& self, Op&& op) -> deferred_monas<F, E, Ops..., std::remove_cvref_t<Op>> {
+      return { std::move(self.m_future), std::forward<E>(self.m_executor), std::tuple_cat(std::move(self.m_ops), std::tuple<std::remove_cvref_t<Op>>(std::forward<Op>(op))) };
+    }
+
+    /**
+    * @brief executorに処理を投げ、チェーンの結果を受け取るstd::futureを返す
+    * @details executor上でfutureの値を待機してからチェーンを実行する、呼び出したスレッドはブロックされない
+    */
+    friend auto operator|(deferred_monas&& self, to_future_impl) -> std::future<deferred_result_t<F, Ops...>> {
+      using result_t = deferred_result_t<F, Ops...>;
+
+      struct state {
+        std::promise<result_t> promise;
+        F future;
+        std::tuple<Ops...> ops;
+      };
+
+      // executorがコピー可能なCallableしか受け付けない場合のために、状態はshared_ptrで共有する
+      auto st = std::make_shared<state>(std::promise<result_t>{}, std::move(self.m_future), std::move(self.m_ops));
+      auto result = st->promise.get_future();
+
+      self.m_executor.execute([st] {
+        auto run = [&] {
+          st->promise.set_value(std::apply([&](auto&... ops) {
+            return unwrap_monas(apply_ops(monas(cpo::unwrap(std::move(st->future))), std::move(ops)...));
+          }, st->ops));
+        };
+
+#ifdef HARMONY_NO_EXCEPTIONS
+        run();
+#else
+        try {
+          run();
+        } catch (...) {
+          st->promise.set_exception(std::current_exception());
+        }
+#endif
+      });
+
+      return result;
+    }
+  };
+
+} // namespace harmony::detail
+
+namespace harmony {
+
+  /**
+  * @brief future-likeな値を待機せずに、後続の処理を継続としてexecutor上で実行するmonasを作成する
+  * @details defer(fut, exec) | map(f) | and_then(g) | to_future のように使用し、to_futureで処理の結果を受け取るstd::futureを得る
+  * @param future future-likeなオブジェクト
+  * @param exec 継続を実行するexecutor、inline_executorを渡した場合はto_futureを呼んだスレッドで待機して実行する
+  */
+  inline constexpr auto defer = []<future_like F, executor E>(F&& future, E&& exec) {
+    static_assert(not std::is_lvalue_reference_v<F>, "future must be an rvalue.");
+    return detail::deferred_monas<std::remove_cvref_t<F>, E>(std::move(future), std::forward<E>(exec), std::tuple<>{});
+  };
+
+  inline namespace monadic_op {
+
+    /**
+    * @brief deferで作成したチェーンを開始し、その結果を受け取るstd::futureを得る
+    */
+    inline constexpr detail::to_future_impl to_future{};
+  }
+}
+
+
+namespace harmony::detail {
+
+  /**
+  * @brief 処理Opをexecutor上で実行し、その結果を受け取るstd::futureを返す
+  * @details 左辺の値はタスクにコピー（右辺値ならムーブ）されるので、呼び出し側のオブジェクトは書き換えられない
+  * @tparam E executorの型、左辺値から構築された場合は参照
+  * @tparam Op executor上で適用する処理
+  */
+  template<typename E, typename Op>
+  struct on_impl {
+    E exec;
+    Op op;
+
+    template<typename T>
+    using result_t = decltype(unwrap_monas(std::declval<monas<std::remove_cvref_t<T>>>() | std::declval<Op>()));
+
+    template<typename T>
+      requires std::constructible_from<std::remove_cvref_t<T>, std::remove_reference_t<T>&> and
+               requires { typename result_t<T>; }
+    friend auto operator|(monas<T>&& m, on_impl self) -> std::future<result_t<T>> {
+      using value_t = std::remove_cvref_t<T>;
+      using held_t = std::conditional_t<std::is_lvalue_reference_v<T>, std::remove_reference_t<T>&, value_t&&>;
+
+      struct state {
+        std::promise<result_t<T>> promise;
+        value_t value;
+        Op op;
+      };
+
+      std::remove_reference_t<T>& held = m;
+      // executorがコピー可能なCallableしか受け付けない場合のために、状態はshared_ptrで共有する
+      auto st = std::make_shared<state>(std::promise<result_t<T>>{}, static_cast<held_t>(held), std::move(self.op));
+      auto result = st->promise.get_future();
+
+      self.exec.execute([st] {
+        auto run = [&] {
+          st->promise.set_value(unwrap_monas(monas<value_t>(std::move(st->value)) | std::move(st->op)));
+        };
+
+#ifdef HARMONY_NO_EXCEPTIONS
+        run();
+#else
+        try {
+          run();
+        } catch (...) {
+          st->promise.set_exception(std::current_exception());
+        }
+#endif
+      });
+
+      return result;
+    }
+
+    template<unwrappable M>
+      requires (not specialization_of<std::remove_cvref_t<M>, monas>) and
+               requires(M&& m, on_impl&& self) { monas(std::forward<M>(m)) | std::move(self); }
+    friend auto operator|(M&& m, on_impl self) {
+      return monas(std::forward<M>(m)) | std::move(self);
+    }
+  };
+
+} // namespace harmony::detail
+
+namespace harmony::inline monadic_op {
+
+  /**
+  * @brief fのbindをexecutor上で実行し、結果のモナド的な値を受け取るstd::futureを返す
+  * @details 返り値はfuture-likeなので、そのままmonasに渡したりdeferで継続させたりできる
+  * @param exec 処理を実行するexecutor（thread_poolなど）、左辺値の場合は参照で保持する
+  * @param f bindする関数、コピーして保持する
+  */
+  inline constexpr auto then_on = []<executor E, typename F>(E&& exec, F&& f) {
+    return detail::on_impl<E, detail::then_impl<std::decay_t<F>>>{ std::forward<E>(exec), { std::forward<F>(f) } };
+  };
+
+  /**
+  * @brief fによるmapをexecutor上で実行し、結果のモナド的な値を受け取るstd::futureを返す
+  * @param exec 処理を実行するexecutor（thread_poolなど）、左辺値の場合は参照で保持する
+  * @param f mapする関数、コピーして保持する
+  */
+  inline constexpr auto map_on = []<executor E, typename F>(E&& exec, F&& f) {
+    return detail::on_impl<E, detail::map_impl<std::decay_t<F>>>{ std::forward<E>(exec), { std::forward<F>(f) } };
+  };
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief future-likeな型から取り出される値の型、参照はstd::reference_wrapperにする（unwrapと同じ）
+  */
+  template<typename F>
+  using future_value_t = std::conditional_t<std::is_reference_v<decltype(std::declval<F>().get())>
+    , std::reference_wrapper<std::remove_reference_t<decltype(std::declval<F>().get())>>
+    , decltype(std::declval<F>().get())>;
+
+  /**
+  * @brief タイムアウト付きで待機できるfuture-likeな型
+  */
+  template<typename F>
+  concept timed_future_like =
+    future_like<F> and
+    requires(F& f) {
+      { f.wait_for(std::chrono::microseconds{}) } -> std::same_as<std::future_status>;
+    };
+
+  /**
+  * @brief 無効な（valid() == falseの）futureを表す例外、get()は未定義動作なので呼ばずにこれを無効値とする
+  * @details 例外が無効な場合はnullのexception_ptrになる
+  */
+  inline auto future_no_state() -> std::exception_ptr {
+    return std::make_exception_ptr(std::future_error(std::future_errc::no_state));
+  }
+
+  /**
+  * @brief fの値をoutに取り出す、例外が送出された場合は最初のものだけをerrorに保存する
+  * @details 無効なfutureはget()せずにfuture_no_state()をerrorとし、outは空のままにする
+  */
+  template<typename F, typename V>
+  void get_future_into(F&& f, std::optional<V>& out, std::exception_ptr& error) {
+    if (not f.valid()) {
+      if (not error) {
+        error = future_no_state();
+      }
+      return;
+    }
+
+#ifdef HARMONY_NO_EXCEPTIONS
+    (void)error;
+    out.emplace(std::forward<F>(f).get());
+#else
+    try {
+      out.emplace(std::forward<F>(f).get());
+    } catch (...) {
+      if (not error) {
+        error = std::current_exception();
+      }
+    }
+#endif
+  }
+
+  /**
+  * @brief when_anyが1つのfutureを待機する時間の上限、準備ができてから検出されるまでの遅延は入力数によらずこの程度に収まる
+  */
+  inline constexpr std::chrono::microseconds when_any_max_slice{1000};
+
+  /**
+  * @brief 準備のできたfutureの番号を返す、無効なfutureや遅延実行のfutureも準備ができているものとみなす
+  * @details 毎回全てのfutureを待機せずに確認してから、1つのfutureだけをwait_forで待機する（待機する対象は順番に変える）。
+  * 待機中に他のfutureの準備ができても、次の確認で検出されるため、遅延は入力数倍にはならずwhen_any_max_slice以下になる。
+  * 同じ確認で複数の準備ができていた場合は番号の小さいものを返す。待機時間は徐々に伸ばし、最大でもwhen_any_max_sliceに抑える
+  */
+  template<typename... Fs>
+  auto wait_any(Fs&... futures) -> std::size_t {
+    constexpr std::size_t npos = sizeof...(Fs);
+    std::chrono::microseconds slice{0};
+    std::size_t turn = 0;
+
+    while (true) {
+      std::size_t found = npos;
+      std::size_t index = 0;
+
+      auto poll = [&](auto& f) {
+        if (found == npos and (not f.valid() or f.wait_for(std::chrono::microseconds{0}) != std::future_status::timeout)) {
+          found = index;
+        }
+        ++index;
+      };
+      (poll(futures), ...);
+
+      if (found != npos) {
+        return found;
+      }
+
+      slice = std::min(slice * 2 + std::chrono::microseconds{50}, when_any_max_slice);
+
+      index = 0;
+      auto wait_turn = [&](auto& f) {
+        if (index++ == turn) {
+          (void)f.wait_for(slice);
+        }
+      };
+      (wait_turn(futures), ...);
+      turn = (turn + 1) % npos;
+    }
+  }
+
+  /**
+  * @brief I番目のfutureが準備できていれば、その値を取り出してoutに構築する
+  */
+  template<std::size_t I, typename S, typename F>
+  void take_ready_future(std::size_t ready, std::optional<S>& out, F&& f) {
+    if (ready != I) return;
+
+    if (not f.valid()) {
+      out.emplace(std::in_place_index<0>, future_no_state());
+      return;
+    }
+
+#ifdef HARMONY_NO_EXCEPTIONS
+    out.emplace(std::in_place_index<1>, std::in_place_index<I>, std::forward<F>(f).get());
+#else
+    try {
+      out.emplace(std::in_place_index<1>, std::in_place_index<I>, std::forward<F>(f).get());
+    } catch (...) {
+      out.emplace(std::in_place_index<0>, std::current_exception());
+    }
+#endif
+  }
+
+} // namespace harmony::detail
+
+namespace harmony {
+
+  /**
+  * @brief 全てのfuture-likeな値を待機し、その値をまとめたタプルを保持するmonasを返す
+  * @details 入力は引数の順にget()されるので、待機時間は最も遅い入力の分だけになる。待機するのは呼び出しスレッドのみ
+  * @details いずれかが例外を送出した場合、残りの入力も全て待機してから、引数順で最初の例外を無効値として保持する。無効なfutureはget()せずにstd::future_error(no_state)とする
+  * @return monas<sachet<std::exception_ptr, std::tuple<T...>>>、参照を返すfutureの値はstd::reference_wrapperになる
+  */
+  inline constexpr auto when_all = []<future_like... Fs>(Fs&&... futures)
+    requires (0 < sizeof...(Fs))
+  {
+    using result_t = sachet<std::exception_ptr, std::tuple<detail::future_value_t<Fs>...>>;
+
+    std::exception_ptr error;
+    std::tuple<std::optional<detail::future_value_t<Fs>>...> values;
+
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (detail::get_future_into(std::forward<Fs>(futures), std::get<I>(values), error), ...);
+
+      // 例外が無効な場合errorはnullになりうるため、値が揃ったかで判定する
+      if (not (std::get<I>(values).has_value() and ...)) {
+        return monas(result_t(std::in_place_index<0>, std::move(error)));
+      }
+      return monas(result_t(std::in_place_index<1>, std::move(*std::get<I>(values))...));
+    }(std::index_sequence_for<Fs...>{});
+  };
+
+  /**
+  * @brief 最初に準備のできたfuture-likeな値を、その番号のvariantとして保持するmonasを返す
+  * @details 追加のスレッドは使わず、呼び出しスレッドが全入力の確認と1つの入力のwait_forを繰り返す（スピンはしない）。
+  * 準備ができてから検出されるまでの遅延はwhen_any_max_slice程度で、入力数には比例しない
+  * @details 無効な（valid() == falseの）入力が選ばれた場合、get()は呼ばずにstd::future_error(no_state)を無効値とする（例外が無効な場合はnullのexception_ptr）
+  * @details 選ばれなかった入力はget()されずにそのまま残る。右辺値で渡したstd::asyncのfutureはデストラクタで完了を待つことに注意
+  * @return monas<sachet<std::exception_ptr, std::variant<T...>>>、variantのインデックスは準備のできた入力の番号
+  */
+  inline constexpr auto when_any = []<detail::timed_future_like... Fs>(Fs&&... futures)
+    requires (0 < sizeof...(Fs))
+  {
+    using result_t = sachet<std::exception_ptr, std::variant<detail::future_value_t<Fs>...>>;
+
+    const std::size_t ready = detail::wait_any(futures...);
+    std::optional<result_t> result;
+
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (detail::take_ready_future<I>(ready, result, std::forward<Fs>(futures)), ...);
+    }(std::index_sequence_for<Fs...>{});
+
+    return monas(std::move(*result));
+  };
+}
+
+namespace harmony {
+
+  /**
+  * @brief with_deadline/untilで、期限までにfutureの準備ができなかったことを表す
+  */
+  struct deadline_exceeded {
+    friend constexpr bool operator==(deadline_exceeded, deadline_exceeded) noexcept = default;
+  };
+
+  /**
+  * @brief with_deadline/untilの無効値の型
+  */
+  using deadline_error = std::variant<deadline_exceeded, std::exception_ptr>;
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief waitで待機した結果準備ができていればfの値を、そうでなければdeadline_exceededを保持するmonasを返す
+  * @details 遅延実行のfutureはその場で実行する。無効なfutureはget()せずにstd::future_error(no_state)を保持する
+  */
+  template<typename F, typename Wait>
+  auto get_before(F&& f, Wait wait) -> monas<sachet<deadline_error, future_value_t<F>>> {
+    using result_t = sachet<deadline_error, future_value_t<F>>;
+
+    if (not f.valid()) {
+      return monas(result_t(std::in_place_index<0>, future_no_state()));
+    }
+    if (wait(f) == std::future_status::timeout) {
+      return monas(result_t(std::in_place_index<0>, deadline_exceeded{}));
+    }
+
+#ifdef HARMONY_NO_EXCEPTIONS
+    return monas(result_t(std::in_place_index<1>, std::forward<F>(f).get()));
+#else
+    try {
+      return monas(result_t(std::in_place_index<1>, std::forward<F>(f).get()));
+    } catch (...) {
+      return monas(result_t(std::in_place_index<0>, std::current_exception()));
+    }
+#endif
+  }
+
+} // namespace harmony::detail
+
+namespace harmony {
+
+  /**
+  * @brief 最大timeoutだけfuture-likeな値を待機する、待機時間を超えた場合はdeadline_exceededを無効値として保持する
+  * @details 期限切れの場合、入力のfutureはget()されずに残る。右辺値で渡したstd::asyncのfutureはデストラクタで完了を待つことに注意
+  * @return monas<sachet<std::variant<deadline_exceeded, std::exception_ptr>, T>>
+  */
+  inline constexpr auto with_deadline = []<detail::timed_future_like F, typename Rep, typename Period>(F&& future, std::chrono::duration<Rep, Period> timeout) {
+    return detail::get_before(std::forward<F>(future), [timeout](auto& f) { return f.wait_for(timeout); });
+  };
+
+  /**
+  * @brief 時刻deadlineまでfuture-likeな値を待機する、それまでに準備ができなければdeadline_exceededを無効値として保持する
+  * @details 1つの期限を複数のfutureで共有すると、チェーン全体の待ち時間の上限を決められる
+  * @return monas<sachet<std::variant<deadline_exceeded, std::exception_ptr>, T>>
+  */
+  inline constexpr auto until = []<future_like F, typename Clock, typename Duration>(F&& future, std::chrono::time_point<Clock, Duration> deadline)
+    requires requires(std::remove_reference_t<F>& f) { { f.wait_until(deadline) } -> std::same_as<std::future_status>; }
+  {
+    return detail::get_before(std::forward<F>(future), [deadline](auto& f) { return f.wait_until(deadline); });
+  };
+}
+
+namespace harmony {
+
+  template<typename T, typename E>
+  class poll_result;
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief 準備中のpoll_resultが保持する、値の取得元
+  */
+  template<typename T, typename E>
+  struct poll_source {
+    virtual ~poll_source() = default;
+
+    /**
+    * @brief 準備ができていれば結果を返す、まだならnullopt
+    * @details 結果を返した後のこのオブジェクトは使用されない
+    */
+    virtual auto try_take() -> std::optional<poll_result<T, E>> = 0;
+  };
+
+  template<typename T, typename E, typename F>
+  class poll_chain;
+
+  template<typename T>
+  struct is_poll_result : std::false_type {};
+
+  template<typename T, typename E>
+  struct is_poll_result<poll_result<T, E>> : std::true_type {};
+
+  /**
+  * @brief poll_result<T, E>にfをbindした結果の型、fがpoll_resultを返す場合は平坦化する
+  */
+  template<typename F, typename T, typename E, typename R = std::remove_cvref_t<std::invoke_result_t<F, T>>>
+  using poll_bind_t = std::conditional_t<is_poll_result<R>::value, R, poll_result<R, E>>;
+
+} // namespace harmony::detail
+
+namespace harmony {
+
+  /**
+  * @brief 準備中、有効値、無効値の3状態を持つ非同期処理の結果
+  * @details 準備中の結果にbindした処理は実行されずに積まれ、poll()で準備ができたときに順番に実行される
+  * @details poll()はブロックしないので、1つのスレッドで多数のチェーンを駆動できる
+  * @tparam T 有効値の型
+  * @tparam E 無効値の型
+  */
+  template<typename T, typename E>
+  class poll_result {
+    using source_ptr = std::unique_ptr<detail::poll_source<T, E>>;
+
+    std::variant<source_ptr, T, E> m_state;
+
+    template<typename, typename>
+    friend class poll_result;
+
+  public:
+
+    using value_type = T;
+    using error_type = E;
+
+    /**
+    * @brief 準備中の結果を、値の取得元から構築する
+    */
+    explicit poll_result(std::in_place_index_t<0>, source_ptr source) noexcept
+      : m_state(std::in_place_index<0>, std::move(source))
+    {}
+
+    /**
+    * @brief 有効値をin-placeに構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<T, Args...>
+    explicit poll_result(std::in_place_index_t<1>, Args&&... args)
+      : m_state(std::in_place_index<1>, std::forward<Args>(args)...)
+    {}
+
+    /**
+    * @brief 無効値をin-placeに構築する
+    */
+    template<typename... Args>
+      requires std::constructible_from<E, Args...>
+    explicit poll_result(std::in_place_index_t<2>, Args&&... args)
+      : m_state(std::in_place_index<2>, std::forward<Args>(args)...)
+    {}
+
+    bool is_pending() const noexcept {
+      return m_state.index() == 0;
+    }
+
+    bool is_ready() const noexcept {
+      return m_state.index() != 0;
+    }
+
+    bool has_value() const noexcept {
+      return m_state.index() == 1;
+    }
+
+    bool has_error() const noexcept {
+      return m_state.index() == 2;
+    }
+
+    /**
+    * @brief 準備中ならば値の取得元を確認し、準備ができていれば積まれた処理を実行して状態を更新する
+    * @return 更新後の状態で準備ができているか
+    */
+    bool poll() {
+      while (is_pending()) {
+        auto next = detail::variant_get<0>(m_state)->try_take();
+        if (not next) {
+          return false;
+        }
+        // 平坦化された処理の結果が再び準備中になることがあるので、準備ができるか取得元が待ちになるまで繰り返す
+        m_state = std::move(next->m_state);
+      }
+      return true;
+    }
+
+    /**
+    * @pre has_value() == true
+    */
+    auto value() & noexcept -> T& {
+      assert(has_value());
+      return detail::variant_get<1>(m_state);
+    }
+
+    auto value() const & noexcept -> const T& {
+      assert(has_value());
+      return detail::variant_get<1>(m_state);
+    }
+
+    auto value() && noexcept -> T&& {
+      assert(has_value());
+      return detail::variant_get<1>(std::move(m_state));
+    }
+
+    /**
+    * @pre has_error() == true
+    */
+    auto error() & noexcept -> E& {
+      assert(has_error());
+      return detail::variant_get<2>(m_state);
+    }
+
+    auto error() const & noexcept -> const E& {
+      assert(has_error());
+      return detail::variant_get<2>(m_state);
+    }
+
+    auto error() && noexcept -> E&& {
+      assert(has_error());
+      return detail::variant_get<2>(std::move(m_state));
+    }
+
+    /**
+    * @brief bind演算子、有効値ならfを適用し、無効値ならそのまま伝播し、準備中ならfを積んで準備中のまま返す
+    * @details fがpoll_resultを返す場合は平坦化されるので、非同期処理を続けて繋ぐことができる
+    */
+    template<typename F>
+      requires std::invocable<F, T> and not_void<std::invoke_result_t<F, T>>
+    friend auto operator|(poll_result&& self, F&& f) -> detail::poll_bind_t<F, T, E> {
+      using result_t = detail::poll_bind_t<F, T, E>;
+
+      switch (self.m_state.index()) {
+      case 1:
+        if constexpr (detail::is_poll_result<std::remove_cvref_t<std::invoke_result_t<F, T>>>::value) {
+          return std::invoke(std::forward<F>(f), detail::variant_get<1>(std::move(self.m_state)));
+        } else {
+          return result_t(std::in_place_index<1>, std::invoke(std::forward<F>(f), detail::variant_get<1>(std::move(self.m_state))));
+        }
+      case 2:
+        return result_t(std::in_place_index<2>, detail::variant_get<2>(std::move(self.m_state)));
+      default:
+        return result_t(std::in_place_index<0>, std::make_unique<detail::poll_chain<T, E, std::decay_t<F>>>(detail::variant_get<0>(std::move(self.m_state)), std::decay_t<F>(std::forward<F>(f))));
+      }
+    }
+  };
+
+} // namespace harmony
+
+namespace harmony::detail {
+
+  /**
+  * @brief 前段の取得元の準備ができたら、その結果にfをbindする取得元
+  */
+  template<typename T, typename E, typename F>
+  class poll_chain final : public poll_source<typename poll_bind_t<F, T, E>::value_type, typename poll_bind_t<F, T, E>::error_type> {
+    using result_t = poll_bind_t<F, T, E>;
+
+    std::unique_ptr<poll_source<T, E>> m_prev;
+    F m_f;
+
+  public:
+
+    poll_chain(std::unique_ptr<poll_source<T, E>> prev, F&& f)
+      : m_prev(std::move(prev))
+      , m_f(std::move(f))
+    {}
+
+    auto try_take() -> std::optional<result_t> override {
+      auto prev = m_prev->try_take();
+      if (not prev) {
+        return std::nullopt;
+      }
+      return std::move(*prev) | std::move(m_f);
+    }
+  };
+
+  /**
+  * @brief future-likeな値を取得元とする、get()の送出した例外を無効値とする
+  */
+  template<typename F>
+  class poll_future final : public poll_source<future_value_t<F>, std::exception_ptr> {
+    using result_t = poll_result<future_value_t<F>, std::exception_ptr>;
+
+    F m_future;
+
+  public:
+
+    explicit poll_future(F&& future)
+      : m_future(std::move(future))
+    {}
+
+    /**
+    * @brief 準備ができていない場合にnulloptを返す、無効なfutureはget()せずにstd::future_error(no_state)を無効値とする
+    */
+    static auto take(F& future) -> std::optional<result_t> {
+      if (not future.valid()) {
+        return result_t(std::in_place_index<2>, future_no_state());
+      }
+      if (future.wait_for(std::chrono::seconds{0}) == std::future_status::timeout) {
+        return std::nullopt;
+      }
+
+#ifdef HARMONY_NO_EXCEPTIONS
+      return result_t(std::in_place_index<1>, future.get());
+#else
+      try {
+        return result_t(std::in_place_index<1>, future.get());
+      } catch (...) {
+        return result_t(std::in_place_index<2>, std::current_exception());
+      }
+#endif
+    }
+
+    auto try_take() -> std::optional<result_t> override {
+      return take(m_future);
+    }
+  };
+
+} // namespace harmony::detail
+
+namespace harmony {
+
+  /**
+  * @brief future-likeな値をブロックせずに確認し、その状態をpoll_resultとして返す
+  * @details 準備ができていなければfutureを保持した準備中の結果を返し、以降はpoll()で確認する
+  * @return poll_result<T, std::exception_ptr>、get()の送出した例外は無効値になる
+  */
+  inline constexpr auto poll = []<detail::timed_future_like F>(F&& future)
+    requires std::constructible_from<std::remove_cvref_t<F>, F>
+  {
+    using future_t = std::remove_cvref_t<F>;
+    using result_t = poll_result<detail::future_value_t<future_t>, std::exception_ptr>;
+
+    future_t fut(std::forward<F>(future));
+    if (auto ready = detail::poll_future<future_t>::take(fut)) {
+      return std::move(*ready);
+    }
+    return result_t(std::in_place_index<0>, std::make_unique<detail::poll_future<future_t>>(std::move(fut)));
+  };
+}
+
+namespace harmony::detail {
+
+  /**
+  * @brief パイプラインの段として合成できる処理（monadic_opの関数が返すオブジェクト）
+  */
+  template<typename Op>
+  inline constexpr bool pipeline_op = false;
+
+  template<typename F>
+  inline constexpr bool pipeline_op<then_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<par_then_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<simd_then_impl<F>> = true;
+  template<typename... Fs>
+  inline constexpr bool pipeline_op<fused_impl<Fs...>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<map_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<map_each_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<flat_map_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<pmr_flat_map_impl<F>> = true;
+  template<typename C, bool Parallel>
+  inline constexpr bool pipeline_op<collect_impl<C, Parallel>> = true;
+  template<typename VC, typename EC, bool Parallel>
+  inline constexpr bool pipeline_op<partition_results_impl<VC, EC, Parallel>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<map_err_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<and_then_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<or_else_impl<F>> = true;
+  template<typename Fok, typename Ferr>
+  inline constexpr bool pipeline_op<match_impl<Fok, Ferr>> = true;
+  template<typename Pred>
+  inline constexpr bool pipeline_op<exists_impl<Pred>> = true;
+  template<validity_query Q>
+  inline constexpr bool pipeline_op<validity_query_impl<Q>> = true;
+  template<typename T, bool IsFold>
+  inline constexpr bool pipeline_op<map_to_impl<T, IsFold>> = true;
+  template<typename U>
+  inline constexpr bool pipeline_op<value_or_impl<U>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<value_or_else_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<inspect_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_op<inspect_err_impl<F>> = true;
+  template<typename E, typename Op>
+  inline constexpr bool pipeline_op<on_impl<E, Op>> = true;
+  template<typename Pred>
+  inline constexpr bool pipeline_op<par_exists_impl<Pred>> = true;
+  template<typename Op>
+  inline constexpr bool pipeline_op<for_all_impl<Op>> = true;
+
+  /**
+  * @brief 保持する関数1つだけをメンバに持ち、それを参照で持つ同種の処理に作り直せる
+  */
+  template<typename Op>
+  inline constexpr bool pipeline_rebindable = false;
+
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<then_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<simd_then_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<map_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<map_each_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<flat_map_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<map_err_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<and_then_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<or_else_impl<F>> = true;
+  template<typename Pred>
+  inline constexpr bool pipeline_rebindable<exists_impl<Pred>> = true;
+  template<typename U>
+  inline constexpr bool pipeline_rebindable<value_or_impl<U>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<inspect_impl<F>> = true;
+  template<typename F>
+  inline constexpr bool pipeline_rebindable<inspect_err_impl<F>> = true;
+
+  /**
+  * @brief 処理を、保持する関数をconst参照で持つ同種の処理に作り直す
+  */
+  template<template<typename> typename Op, typename F>
+    requires pipeline_rebindable<Op<F>>
+  constexpr auto rebind_as_ref(const Op<F>& op) noexcept -> Op<const std::remove_reference_t<F>&> {
+    const auto& [f] = op;
+    return { f };
+  }
+
+  template<typename F>
+    requires std::invocable<const std::remove_reference_t<F>&>
+  constexpr auto rebind_as_ref(const value_or_else_impl<F>& op) noexcept -> value_or_else_impl<const std::remove_reference_t<F>&> {
+    return { op.tmp_f };
+  }
+
+  template<typename F>
+  constexpr auto rebind_as_ref(const par_then_impl<F>& op) noexcept -> par_then_impl<const std::remove_reference_t<F>&> {
+    return { op.fmap, op.grain, op.exec };
+  }
+
+  template<typename F>
+  constexpr auto rebind_as_ref(const pmr_flat_map_impl<F>& op) noexcept -> pmr_flat_map_impl<const std::remove_reference_t<F>&> {
+    return { op.fmap, op.resource };
+  }
+
+  template<typename... Fs>
+  constexpr auto rebind_as_ref(const fused_impl<Fs...>& op) noexcept -> fused_impl<const std::remove_reference_t<Fs>&...> {
+    return { std::apply([](const auto&... fs) { return std::tuple<const std::remove_reference_t<Fs>&...>(fs...); }, op.fmaps) };
+  }
+
+  template<typename Fok, typename Ferr>
+  constexpr auto rebind_as_ref(const match_impl<Fok, Ferr>& op) noexcept -> match_impl<const std::remove_reference_t<Fok>&, const std::remove_reference_t<Ferr>&> {
+    return { op.fmap_ok, op.fmap_err };
+  }
+
+  template<typename Pred>
+  constexpr auto rebind_as_ref(const par_exists_impl<Pred>& op) noexcept -> par_exists_impl<const std::remove_reference_t<Pred>&> {
+    return { op.f_pred, op.grain, op.exec };
+  }
+
+  template<typename Op>
+    requires requires(const Op& op) { rebind_as_ref(op); }
+  constexpr auto rebind_as_ref(const for_all_impl<Op>& op) noexcept -> for_all_impl<decltype(rebind_as_ref(op.op))> {
+    return { rebind_as_ref(op.op) };
+  }
+
+  /**
+  * @details タスクは処理をパイプラインへの参照として持つので、then_on/map_onを含むパイプラインは返されたfutureの完了まで生存している必要がある
+  */
+  template<typename E, typename Op>
+    requires requires(const Op& op) { rebind_as_ref(op); } and
+             (std::is_reference_v<E> or executor<const E>)
+  constexpr auto rebind_as_ref(const on_impl<E, Op>& op) noexcept {
+    using exec_t = std::conditional_t<std::is_reference_v<E>, E, const E&>;
+    return on_impl<exec_t, decltype(rebind_as_ref(op.op))>{ op.exec, rebind_as_ref(op.op) };
+  }
+
+  /**
+  * @brief パイプラインの1段を、適用1回分の引数に変換する
+  * @details 関数を持つ処理は参照で作り直し、関数を持たない処理（map_toなど）はコピーする。処理でない関数はbindされるのでconst参照のまま渡す
+  */
+  template<typename Stage>
+  constexpr decltype(auto) pipeline_stage_arg(const Stage& stage) {
+    if constexpr (requires { rebind_as_ref(stage); }) {
+      return rebind_as_ref(stage);
+    } else if constexpr (pipeline_op<Stage>) {
+      return Stage(stage);
+    } else {
+      return (stage);
+    }
+  }
+
+  /**
+  * @brief 処理を合成して1つのオブジェクトにしたもの
+  * @details 適用時には各段を参照で組み立て直すだけなので、何度適用しても段の関数はコピーされない
+  * @details 段の関数がconstで呼び出し可能ならば、1つのパイプラインを複数スレッドから同時に適用できる
+  * @tparam Stages 各段の型（処理、もしくはbindする関数）
+  */
+  template<typename... Stages>
+  class pipeline;
+
+  template<typename T>
+  inline constexpr bool is_pipeline = false;
+
+  template<typename... Stages>
+  inline constexpr bool is_pipeline<pipeline<Stages...>> = true;
+
+  template<typename... Stages>
+  class pipeline {
+    [[no_unique_address]] std::tuple<Stages...> m_stages;
+
+    template<typename M, std::size_t... I>
+    constexpr auto apply(M&& m, std::index_sequence<I...>) const {
+      return apply_ops(monas(std::forward<M>(m)), pipeline_stage_arg(std::get<I>(m_stages))...);
+    }
+
+  public:
+
+    constexpr explicit pipeline(std::tuple<Stages...>&& stages)
+      : m_stages(std::move(stages))
+    {}
+
+    constexpr auto stages() const & noexcept -> const std::tuple<Stages...>& {
+      return m_stages;
+    }
+
+    constexpr auto stages() && noexcept -> std::tuple<Stages...>&& {
+      return std::move(m_stages);
+    }
+
+    /**
+    * @brief 先頭の段から順番に適用する、結果は同じ処理を直接チェーンした場合と同じになる
+    */
+    template<typename M>
+      requires (not is_pipeline<std::remove_cvref_t<M>>) and
+               requires(M&& m) { monas(std::forward<M>(m)); }
+    friend constexpr auto operator|(M&& m, const pipeline& self) {
+      return self.apply(std::forward<M>(m), std::index_sequence_for<Stages...>{});
+    }
+  };
+
+  template<typename... Stages>
+  inline constexpr bool pipeline_op<pipeline<Stages...>> = true;
+
+  /**
+  * @brief パイプラインの段になれる型、処理かbindできる関数オブジェクト（関数ポインタ）
+  */
+  template<typename S>
+  concept pipeline_stage = std::copy_constructible<std::decay_t<S>> and
+                           (pipeline_op<std::decay_t<S>> or std::is_class_v<std::decay_t<S>> or std::is_function_v<std::remove_pointer_t<std::decay_t<S>>>);
+
+  template<typename S>
+  constexpr auto as_stage_tuple(S&& s) {
+    if constexpr (is_pipeline<std::remove_cvref_t<S>>) {
+      return std::forward<S>(s).stages();
+    } else {
+      return std::tuple<std::decay_t<S>>(std::forward<S>(s));
+    }
+  }
+
+  template<typename... Stages>
+  constexpr auto make_pipeline(std::tuple<Stages...>&& stages) -> pipeline<Stages...> {
+    return pipeline<Stages...>(std::move(stages));
+  }
+
+  /**
+  * @brief 2つの段を合成してパイプラインを作る、どちらかはmonadic_opの処理かパイプラインである必要がある
+  * @details パイプライン同士は平坦に連結される。処理でない関数オブジェクトはbindとして扱われる
+  */
+  template<pipeline_stage L, pipeline_stage R>
+    requires pipeline_op<std::decay_t<L>> or pipeline_op<std::decay_t<R>>
+  constexpr auto operator>>(L&& lhs, R&& rhs) {
+    return make_pipeline(std::tuple_cat(as_stage_tuple(std::forward<L>(lhs)), as_stage_tuple(std::forward<R>(rhs))));
+  }
+}
+
+
+#ifdef __cpp_lib_coroutine
+
+namespace harmony {
+
+  /**
+  * @brief 有効値を持たないことがあるコルーチンの戻り値型、std::optional<T>そのもの
+  * @details std::optional<T>に対してstd::coroutine_traitsを特殊化することはできないため、コルーチンの戻り値にはこの型を使用する
+  */
+  template<typename T>
+  class maybe_task : public std::optional<T> {
+  public:
+    using std::optional<T>::optional;
+
+    constexpr maybe_task(std::optional<T>&& opt) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : std::optional<T>(std::move(opt))
+    {}
+
+    constexpr maybe_task(const std::optional<T>& opt)
+      : std::optional<T>(opt)
+    {}
+  };
+
+} // namespace harmony
+
+namespace harmony::detail {
+
+  template<typename T>
+  struct result_builder<maybe_task<T>> {
+
+    template<typename U>
+      requires std::constructible_from<maybe_task<T>, U>
+    static constexpr auto valid(U&& v) -> maybe_task<T> {
+      return maybe_task<T>(std::forward<U>(v));
+    }
+
+    template<maybe M>
+    static constexpr auto invalid(M&&) noexcept -> maybe_task<T> {
+      return std::nullopt;
+    }
+  };
+
+  /**
+  * @brief コルーチンフレームの再利用キャッシュ
+  * @details HALOによってフレームの確保が省略されない環境のために、解放されたフレームをスレッドごとにサイズ別のフリーリストで保持して使いまわす
+  */
+  class coroutine_frame_cache {
+    static constexpr std::size_t granularity = 64;
+    static constexpr std::size_t bucket_count = 16;
+
+    struct node {
+      node* next;
+    };
+
+    node* m_buckets[bucket_count]{};
+
+    coroutine_frame_cache() = default;
+
+    ~coroutine_frame_cache() {
+      for (std::size_t i = 0; i < bucket_count; ++i) {
+        while (node* n = m_buckets[i]) {
+          m_buckets[i] = n->next;
+          ::operator delete(n, (i + 1) * granularity);
+        }
+      }
+    }
+
+    static auto instance() -> coroutine_frame_cache& {
+      thread_local coroutine_frame_cache cache;
+      return cache;
+    }
+
+  public:
+
+    static auto allocate(std::size_t size) -> void* {
+      const std::size_t index = (size - 1) / granularity;
+
+      if (index < bucket_count) {
+        node*& head = instance().m_buckets[index];
+        if (head != nullptr) {
+          return std::exchange(head, head->next);
+        }
+        return ::operator new((index + 1) * granularity);
+      }
+
+      return ::operator new(size);
+    }
+
+    static void deallocate(void* p, std::size_t size) noexcept {
+      const std::size_t index = (size - 1) / granularity;
+
+      if (index < bucket_count) {
+        node*& head = instance().m_buckets[index];
+        head = ::new (p) node{ head };
+        return;
+      }
+
+      ::operator delete(p, size);
+    }
+  };
+
+  template<typename R>
+  class monadic_promise;
+
+  /**
+  * @brief get_return_object()の結果、戻り値型への変換時にコルーチンを最後まで実行する
+  * @details 変換はコルーチンが初期サスペンドポイントで中断し、呼び出し元に戻る時に行われる必要がある（遅延変換、GCC・MSVCの動作）。
+  * get_return_object()の直後に変換する処理系ではその時点でコルーチンを再開できず戻り値を作れないので、変換時にそれを検出してstd::terminate()する。
+  * フレームはこのオブジェクトの中で生成・破棄されエスケープしないので、インライン化されればフレームの確保は省略されうる（HALO）
+  */
+  template<typename R>
+  class monadic_return_object {
+    std::coroutine_handle<monadic_promise<R>> m_handle;
+
+  public:
+
+    explicit monadic_return_object(std::coroutine_handle<monadic_promise<R>> h) noexcept
+      : m_handle(h)
+    {}
+
+    monadic_return_object(monadic_return_object&& that) noexcept
+      : m_handle(std::exchange(that.m_handle, nullptr))
+    {}
+
+    ~monadic_return_object() {
+      if (m_handle) m_handle.destroy();
+    }
+
+    operator R() {
+      // 初期サスペンドポイントで中断する前（get_return_object()の直後）に変換された
+      if (not m_handle.promise().m_suspended) {
+        std::terminate();
+      }
+
+#ifdef HARMONY_NO_EXCEPTIONS
+      m_handle.resume();
+#else
+      try {
+        m_handle.resume();
+      } catch (...) {
+        // この変換はコルーチンの呼び出しの中で行われるため、例外で抜けた場合はフレームは処理系によって破棄される
+        m_handle = nullptr;
+        throw;
+      }
+#endif
+      return std::move(*m_handle.promise().m_result);
+    }
+  };
+
+  /**
+  * @brief co_awaitされたmaybeな値が無効値の場合に、コルーチンを中断して無効値を戻り値とする
+  * @tparam M 左辺値から構築された場合は参照
+  */
+  template<typename R, typename M>
+  struct maybe_awaiter {
+    M m;
+
+    constexpr bool await_ready() const noexcept(noexcept(cpo::validate(m))) {
+      return cpo::validate(m);
+    }
+
+    void await_suspend(std::coroutine_handle<monadic_promise<R>> h) {
+      h.promise().m_result.emplace(result_builder<R>::invalid(std::forward<M>(m)));
+    }
+
+    /**
+    * @details 右辺値の場合はawaiterの寿命に縛られないように値で返す
+    */
+    constexpr auto await_resume() -> std::conditional_t<std::is_lvalue_reference_v<M>, traits::unwrap_t<M>, std::remove_cvref_t<traits::unwrap_t<M>>> {
+      return cpo::unwrap(std::forward<M>(m));
+    }
+  };
+
+  /**
+  * @brief maybe/eitherを返すコルーチンのpromise_type
+  * @details 中断は無効値による早期リターンの時のみ起こり、呼び出し元から再開されることはない
+  */
+  template<typename R>
+  class monadic_promise {
+    std::optional<R> m_result;
+    // 初期サスペンドポイントで中断したか
+    bool m_suspended = false;
+
+    /**
+    * @brief 中断したことを記録する初期サスペンドポイント
+    */
+    struct initial_awaiter {
+      monadic_promise& promise;
+
+      constexpr bool await_ready() const noexcept {
+        return false;
+      }
+
+      constexpr void await_suspend(std::coroutine_handle<>) const noexcept {
+        promise.m_suspended = true;
+      }
+
+      constexpr void await_resume() const noexcept {}
+    };
+
+    friend class monadic_return_object<R>;
+
+    template<typename, typename>
+    friend struct maybe_awaiter;
+
+  public:
+
+    static auto operator new(std::size_t size) -> void* {
+      return coroutine_frame_cache::allocate(size);
+    }
+
+    static void operator delete(void* p, std::size_t size) noexcept {
+      coroutine_frame_cache::deallocate(p, size);
+    }
+
+    auto get_return_object() noexcept -> monadic_return_object<R> {
+      return monadic_return_object<R>(std::coroutine_handle<monadic_promise>::from_promise(*this));
+    }
+
+    constexpr auto initial_suspend() noexcept -> initial_awaiter {
+      return { *this };
+    }
+
+    constexpr auto final_suspend() const noexcept -> std::suspend_always {
+      return {};
+    }
+
+    template<typename U>
+      requires requires(U&& v) { result_builder<R>::valid(std::forward<U>(v)); }
+    void return_value(U&& v) {
+      m_result.emplace(result_builder<R>::valid(std::forward<U>(v)));
+    }
+
+    [[noreturn]]
+    void unhandled_exception() {
+#ifdef HARMONY_NO_EXCEPTIONS
+      std::terminate();
+#else
+      throw;
+#endif
+    }
+
+    template<maybe M>
+      requires requires(M&& m) { result_builder<R>::invalid(std::forward<M>(m)); }
+    constexpr auto await_transform(M&& m) -> maybe_awaiter<R, M> {
+      return { std::forward<M>(m) };
+    }
+  };
+
+} // namespace harmony::detail
+
+/**
+* @brief sachet<L, R>を戻り値とする関数をコルーチンにし、co_awaitでeither/maybeな値を取り出せるようにする
+*/
+template<typename L, typename R, typename... Args>
+  requires (not std::same_as<L, harmony::nil>)
+struct std::coroutine_traits<harmony::sachet<L, R>, Args...> {
+  using promise_type = harmony::detail::monadic_promise<harmony::sachet<L, R>>;
+};
+
+/**
+* @brief maybe_task<T>を戻り値とする関数をコルーチンにし、co_awaitでmaybeな値を取り出せるようにする
+*/
+template<typename T, typename... Args>
+struct std::coroutine_traits<harmony::maybe_task<T>, Args...> {
+  using promise_type = harmony::detail::monadic_promise<harmony::maybe_task<T>>;
+};
+
+#endif // __cpp_lib_coroutine
 
 #ifdef _MSC_VER
 #pragma warning( pop )
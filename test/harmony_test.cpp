@@ -10,6 +10,8 @@
 #include <future>
 #include <system_error>
 #include <numbers>
+#include <numeric>
+#include <memory_resource>
 
 #ifdef _MSC_VER
 #pragma warning( push )
@@ -70,6 +72,69 @@ struct simple_unwrappable {
   }
 };
 
+/**
+* @brief コピーされた回数を数える、引数によらずR{1}を返すCallable
+*/
+template<typename R>
+struct copy_counted {
+  int* copies;
+
+  copy_counted(int* c) : copies(c) {}
+  copy_counted(const copy_counted& other) : copies(other.copies) { ++*copies; }
+
+  template<typename... Args>
+  auto operator()(Args&&...) const -> R {
+    return R{1};
+  }
+};
+
+/**
+* @brief コピーされた回数を数える値（有効値・無効値のどちらにも使う）
+*/
+struct copy_counted_value {
+  int* copies = nullptr;
+
+  copy_counted_value() = default;
+  explicit copy_counted_value(int* c) : copies(c) {}
+  copy_counted_value(const copy_counted_value& other) : copies(other.copies) { ++*copies; }
+  copy_counted_value(copy_counted_value&&) = default;
+  auto operator=(const copy_counted_value& other) -> copy_counted_value& { copies = other.copies; ++*copies; return *this; }
+  auto operator=(copy_counted_value&&) -> copy_counted_value& = default;
+};
+
+/**
+* @brief 渡された処理の数を数えてから、thread_poolに転送するexecutor
+*/
+struct counting_executor {
+  harmony::thread_pool& pool;
+  std::atomic<int> submitted = 0;
+
+  template<std::invocable F>
+  void execute(F&& f) {
+    submitted.fetch_add(1);
+    pool.execute(std::forward<F>(f));
+  }
+};
+
+/**
+* @brief m | opが有効な式か（オーバーロード候補から外れることの確認用）
+*/
+template<typename M, typename Op>
+concept pipeable = requires(M& m, Op op) { m | op; };
+
+#ifdef __cpp_lib_source_location
+
+/**
+* @brief 関数テンプレート内のfunnelはインスタンス毎に数えられる
+*/
+template<typename T>
+auto funnel_in_template(std::optional<T> x) -> T {
+  return harmony::funnel(x)
+    | [](T n) { return n + 1; }
+    | harmony::value_or(T{});
+}
+
+#endif
 
 namespace ut = boost::ut;
 
@@ -209,6 +274,7 @@ int main() {
       using either_t = decltype(future_either);
       ut::expect(std::same_as<std::variant<std::exception_ptr, int>, either_t>);
     }
+#ifndef HARMONY_NO_EXCEPTIONS
     {
       std::future<int> f{};
 
@@ -222,6 +288,7 @@ int main() {
         ut::expect(false);
       }
     }
+#endif
     {
       int n = 20;
       auto f = std::async([&n]() mutable -> int& { return n; });
@@ -413,6 +480,70 @@ int main() {
     20_i == *m2;
   };
 
+  "type sachet test"_test = [] {
+    using harmony::sachet;
+
+    ut::expect(harmony::either<sachet<std::exception_ptr, int>>);
+    ut::expect(std::is_trivially_copyable_v<sachet<int, double>>);
+    ut::expect(std::is_trivially_destructible_v<sachet<int, double>>);
+    ut::expect(not std::is_trivially_copyable_v<sachet<std::string, int>>);
+    ut::expect(sizeof(sachet<int, int>) == 2 * sizeof(int));
+    ut::expect(sizeof(sachet<std::exception_ptr, int>) <= sizeof(std::variant<std::exception_ptr, int>));
+
+    {
+      constexpr sachet<int, double> s(std::in_place_index<1>, 1.5);
+      static_assert(s);
+      static_assert(*s == 1.5);
+
+      constexpr sachet<int, double> e(std::in_place_index<0>, 10);
+      static_assert(not e);
+      static_assert(e.unwrap_err() == 10);
+    }
+    {
+      sachet<std::string, std::string> s(std::in_place_index<1>, "valid");
+      sachet<std::string, std::string> e(std::in_place_index<0>, "error");
+
+      // 保持する値の種類が異なるオブジェクト同士の代入
+      auto s2 = s;
+      s2 = e;
+      ut::expect(not s2);
+      ut::expect(s2.unwrap_err() == "error");
+
+      s2 = std::move(s);
+      ut::expect(bool(s2));
+      ut::expect(*s2 == "valid");
+
+      s2 = s2;
+      ut::expect(*s2 == "valid");
+    }
+    {
+      sachet<int, std::string> s = std::variant<int, std::string>(std::in_place_index<1>, "str");
+      ut::expect(bool(s));
+      ut::expect(*s == "str");
+
+      sachet<int, std::string> e = std::variant<int, std::string>(std::in_place_index<0>, 20);
+      ut::expect(not e);
+      ut::expect(20_i == e.unwrap_err());
+
+      sachet<int, std::string> d;
+      ut::expect(not d);
+      ut::expect(0_i == d.unwrap_err());
+    }
+    {
+      // std::variantとの相互変換
+      const std::variant<int, std::string> v(std::in_place_index<1>, "str");
+      sachet<int, std::string> s = v;
+      ut::expect(s.to_variant() == v);
+
+      sachet<int, std::string> e(std::in_place_index<0>, 30);
+      auto ev = std::move(e).to_variant();
+      ut::expect(ev.index() == 0);
+      ut::expect(30_i == std::get<0>(ev));
+
+      static_assert(sachet<int, double>(std::in_place_index<1>, 2.5).to_variant().index() == 1);
+    }
+  };
+
   "monas bind test"_test = [] {
     {
       std::optional<int> opt = 10;
@@ -591,6 +722,221 @@ int main() {
     }
   };
 
+  "par_then test"_test = [] {
+    using namespace harmony::monadic_op;
+    {
+      std::vector<int> vec(100000);
+      std::iota(vec.begin(), vec.end(), 0);
+
+      // 小さいgrainで強制的に分割させる
+      auto r = vec
+        | par_then([](int n) { return 2 * n; }, 1000)
+        | [](int n) { return n + 1; };
+
+      !ut::expect(harmony::validate(r));
+      ut::expect(std::ranges::equal(vec, std::views::iota(0, 100000) | std::views::transform([](int n) { return 2 * n + 1; })));
+    }
+    {
+      // ランダムアクセスできないlistは逐次処理にフォールバック
+      std::list<int> li = {1, 2, 3, 4, 5};
+
+      auto r = harmony::monas(li) | par_then([](int n) { return n * n; });
+
+      !ut::expect(harmony::validate(r));
+      int arr[] = {1, 4, 9, 16, 25};
+      ut::expect(std::ranges::equal(arr, li));
+    }
+    {
+      // listでないものもthenと同じ振る舞いになる
+      std::optional<int> opt = 10;
+
+      std::optional<int> result = opt | par_then([](int n) { return n + n; });
+
+      ut::expect(result == 20);
+    }
+    {
+      // executorを指定すると、ワーカーはその上で動く（呼び出しスレッドの分を除いて高々ワーカー数-1個）
+      harmony::thread_pool pool{2};
+      counting_executor exec{ pool };
+      std::vector<int> vec(100000, 1);
+
+      for (int i = 0; i < 3; ++i) {
+        vec | par_then([](int n) { return n + 1; }, 1000, exec);
+      }
+
+      ut::expect(std::ranges::all_of(vec, [](int n) { return n == 4; }));
+      ut::expect(exec.submitted.load() <= 3 * int(harmony::detail::hardware_workers() - 1));
+
+      ut::expect(vec | par_exists([](int n) { return n == 4; }, 1000, exec));
+      ut::expect(vec | par_for_all([](int n) { return n == 4; }, 1000, exec));
+
+      std::vector<std::optional<int>> opts(10000, 1);
+      auto c = opts | par_collect<std::vector<int>>(100, exec);
+      ut::expect(harmony::validate(c));
+      ut::expect(harmony::unwrap(c).size() == 10000_ul);
+    }
+    {
+      // executorのワーカー上から同じexecutorで並列化しても、呼び出しスレッドが残りを処理するのでデッドロックしない
+      harmony::thread_pool pool{1};
+      std::vector<int> vec(100000, 0);
+      std::promise<void> done;
+
+      pool.execute([&] {
+        vec | par_then([](int n) { return n + 1; }, 1000, pool);
+        done.set_value();
+      });
+
+      auto f = done.get_future();
+      ut::expect(f.wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+      ut::expect(std::ranges::all_of(vec, [](int n) { return n == 1; }));
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      // ワーカーで発生した例外は呼び出し元に伝搬する
+      std::vector<int> vec(10000, 1);
+      bool thrown = false;
+
+      try {
+        vec | par_then([](int n) -> int { throw n; }, 100);
+      } catch (int) {
+        thrown = true;
+      }
+
+      ut::expect(thrown);
+    }
+#endif
+  };
+
+  "simd_then test"_test = [] {
+    using namespace harmony::monadic_op;
+    {
+      // simd幅で割り切れない要素数で端数処理も確認する
+      std::vector<int> vec(1001);
+      std::iota(vec.begin(), vec.end(), 0);
+
+      auto r = vec | simd_then([](auto x) { return x * 2 + 1; });
+
+      !ut::expect(harmony::validate(r));
+      ut::expect(std::ranges::equal(vec, std::views::iota(0, 1001) | std::views::transform([](int n) { return 2 * n + 1; })));
+    }
+    {
+      std::vector<float> vec = {1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f};
+
+      harmony::monas(vec) | simd_then([](auto x) { return x * 0.5f; });
+
+      float arr[] = {0.5f, 1.0f, 1.5f, 2.0f, 2.5f, 3.0f, 3.5f};
+      ut::expect(std::ranges::equal(arr, vec));
+    }
+    {
+      // simd型を受け取れない関数は通常のbindになる
+      std::vector<double> vec = {1.0, 2.0, 3.0};
+
+      vec | simd_then([](double d) { return d + 1.0; });
+
+      double arr[] = {2.0, 3.0, 4.0};
+      ut::expect(std::ranges::equal(arr, vec));
+    }
+    {
+      // 連続していない範囲も通常のbindになる
+      std::list<int> li = {1, 2, 3};
+
+      harmony::monas(li) | simd_then([](auto x) { return x + x; });
+
+      int arr[] = {2, 4, 6};
+      ut::expect(std::ranges::equal(arr, li));
+    }
+  };
+
+  "fused test"_test = [] {
+    using namespace harmony::monadic_op;
+    {
+      std::optional<int> opt = 10;
+
+      std::optional<int> result = harmony::monas(opt)
+        | fused([](int n) { return n + n; },
+                [](int n) { return std::optional<int>{n + 100}; },
+                [](int n) { return n * 2; });
+
+      !ut::expect(harmony::validate(result));
+      240_i == harmony::unwrap(result);
+      // 状態は起点のオブジェクトに伝搬する
+      ut::expect(opt == result);
+    }
+    {
+      // 途中で失敗する処理のチェーン
+      std::optional<int> opt = 10;
+      int count = 0;
+
+      std::optional<int> result = opt
+        | fused([&](int n) { ++count; return n + 100; },
+                [&](int)   { ++count; return std::nullopt; },
+                [&](int n) { ++count; return n * n; });
+
+      ut::expect(not harmony::validate(result));
+      ut::expect(not harmony::validate(opt));
+      ut::expect(count == 2);
+    }
+    {
+      // maybeを返す関数で失敗する
+      std::optional<int> opt = 10;
+
+      std::optional<int> result = opt
+        | fused([](int) { return std::optional<int>{}; },
+                [](int n) { return n * n; });
+
+      ut::expect(not harmony::validate(result));
+    }
+    {
+      // 無効値からは何も呼ばれない
+      std::optional<int> opt{};
+
+      auto m = harmony::monas(opt) | fused([](int) { ut::expect(false); return 0; });
+
+      ut::expect(not harmony::validate(m));
+    }
+    {
+      // 戻り値のない関数や型を変える関数を挟む
+      std::optional<std::string> opt = "abc";
+      std::size_t len = 0;
+
+      std::optional<std::string> result = opt
+        | fused([](const std::string& str) { return str + "def"; },
+                [&](const std::string& str) { len = str.size(); },
+                [](std::string& str) { return str + "g"; });
+
+      ut::expect(len == 6);
+      ut::expect(result == "abcdefg");
+    }
+    {
+      // 通常のbindと同じ結果になる
+      tl::expected<int, std::string> ex{10};
+      tl::expected<int, std::string> ex2{10};
+
+      auto f = [](int n) { return n * 3; };
+      auto g = [](int n) { return n - 1; };
+
+      harmony::monas(ex) | fused(f, g, f);
+      harmony::monas(ex2) | f | g | f;
+
+      ut::expect(ex == ex2);
+    }
+    {
+      // 途中の関数が呼び出せない、または結果を再代入できない場合は、オーバーロード候補から外れる
+      auto inc = [](int n) { return n + 1; };
+      auto to_str = [](int n) { return std::to_string(n); };
+      auto append = [](std::string& str) { str += "!"; };
+      auto takes_vec = [](const std::vector<int>& v) { return int(v.size()); };
+
+      using fine_t = decltype(fused(inc, inc));
+      using mismatch_t = decltype(fused(inc, takes_vec, inc));
+      using unassignable_t = decltype(fused(to_str, append));
+
+      static_assert(pipeable<std::optional<int>, fine_t>);
+      static_assert(not pipeable<std::optional<int>, mismatch_t>);
+      static_assert(not pipeable<std::optional<int>, unassignable_t>);
+    }
+  };
+
   "map test"_test = [] {
     using namespace harmony::monadic_op;
     {
@@ -653,148 +999,1436 @@ int main() {
     }
   };
 
-  "map_err test"_test = [] {
+  "map_each test"_test = [] {
     using namespace harmony::monadic_op;
+    using namespace std::string_view_literals;
     {
-      int n = 10;
+      std::vector<int> vec = {1, 2, 3, 4, 5};
+      int count = 0;
 
-      auto r = harmony::monas(&n) 
-        | [](int n) { return n + n; }
-        | [](int n) { return n + 100; }
-        | map_err([](std::nullptr_t) {assert(false); return nullptr; })
-        | map([](int) { return std::optional<int>{};})
-        | map_err([](std::nullopt_t) { return false;})
-        | map([](int v) { assert(false); return v; });
+      auto view = harmony::monas(vec)
+        | map_each([&count](int n) { ++count; return n * 2; })
+        | map_each([](int n) { return std::to_string(n); });
 
-      !ut::expect(not harmony::validate(r));
-      ut::expect(harmony::unwrap_other(r) == false);
-    } 
-    {
-      auto r = harmony::monas(std::optional<int>{10}) 
-        | [](int n) { return n + n; }
-        | [](int) { return std::nullopt; }
-        | map_err([](std::nullopt_t) { return nullptr;})
-        | map_err([](std::nullptr_t) { return false;})
-        | map([](int n) { assert(false); return n; })
-        | map_err([](bool b) { return std::optional{b};})
-        | map_err([](std::nullopt_t) { assert(false); return std::optional<bool>{true};});
+      // map_to<Container>まで変換は行われない
+      ut::expect(0_i == count);
 
-      !ut::expect(harmony::validate(r));
-      ut::expect(harmony::unwrap(r) == false);
-    }
+      auto strs = std::move(view) | map_to<std::vector<std::string>>;
 
+      ut::expect(5_i == count);
+      ut::expect(strs.size() == 5);
+      ut::expect(strs.capacity() >= 5);
+      ut::expect(strs[0] == "2"sv);
+      ut::expect(strs[4] == "10"sv);
+
+      // 元の範囲は変更されない
+      ut::expect(1_i == vec[0]);
+    }
     {
-      using namespace std::string_view_literals;
+      // monasが所有する範囲はビューに移動される
+      auto lst = harmony::monas(std::list<int>{1, 2, 3})
+        | map_each([](int n) { return n + 0.5; })
+        | map_to<std::list<double>>;
 
-      tl::expected<int, std::string> ex{10};
+      ut::expect(lst.size() == 3);
+      ut::expect(1.5_d == lst.front());
+      ut::expect(3.5_d == lst.back());
+    }
+    {
+      const std::vector<int> vec = {3, 1, 2};
 
-      auto r = harmony::monas(ex)
-        | [](int n) { return 2*n; }
-        | [](int) { return tl::expected<int, std::string>{tl::unexpect, "fail test"};}
-        | map_err([](std::string str) { str.append(" map_err"); return str; })  // ここのmap_errでMSVCはこける
-        | map_err([](std::string str) { return str == "fail test map_err"sv;})
-        | map([](int n) { assert(false); return n;});
+      auto sum = vec
+        | map_each([](int n) { return n * n; })
+        | map([](auto view) { return std::accumulate(view.begin(), view.end(), 0); })
+        | map_to<int>;
 
-      !ut::expect(not harmony::validate(r));
-      ut::expect(harmony::unwrap_other(r) == true);
+      ut::expect(14_i == sum);
     }
   };
 
-  "and_then test"_test = []() {
+  "flat_map test"_test = [] {
     using namespace harmony::monadic_op;
 
+    // 空かどうかを判定できない入力範囲はmaybeにならない
+    static_assert(not harmony::maybe<decltype(std::views::join(std::views::transform(std::views::iota(0, 3), [](int n) { return std::vector<int>(n); })))>);
+    static_assert(not harmony::maybe<std::ranges::basic_istream_view<int, char>>);
     {
-      auto opt = harmony::monas(std::optional<int>{10}) 
-        | [](int n) { return n + n; }
-        | and_then([](int n) { return std::optional<int>{n + 100}; })
-        | [](int n) { return ++n;}
-        | and_then([](int n) { return std::optional<double>(double(n)); });
+      std::vector<int> vec = {1, 2, 3};
 
-      !ut::expect(harmony::validate(opt));
-      121.0_d == harmony::unwrap(opt);
+      // n -> [n, n, ...]（n個）
+      auto repeat = [](int n) { return std::vector<int>(std::size_t(n), n); };
 
-      auto fail = ~opt
-        | [](double) { return std::nullopt; }
-        | and_then([](double d) { assert(false); return std::optional<double>(++d); });
+      auto r = harmony::monas(vec)
+        | flat_map(repeat)
+        | map_to<std::vector<int>>;
 
-      ut::expect(not harmony::validate(fail));
-    }
+      ut::expect(r == std::vector<int>{1, 2, 2, 3, 3, 3});
+
+      // 要素数0の範囲を返すと、その要素は取り除かれる
+      auto evens = vec
+        | flat_map([](int n) { return n % 2 == 0 ? std::vector<int>{n} : std::vector<int>{}; })
+        | map_to<std::vector<int>>;
+
+      ut::expect(evens == std::vector<int>{2});
 
+      // 遅延評価されるため、map_eachと組み合わせても中間のコンテナは作られない
+      auto strs = harmony::monas(std::vector<int>{1, 2})
+        | flat_map(repeat)
+        | map_each([](int n) { return std::to_string(n); })
+        | map_to<std::vector<std::string>>;
+
+      ut::expect(strs == std::vector<std::string>{"1", "2", "2"});
+
+      // flat_mapを重ねても連結は1段のまま
+      auto nested = harmony::monas(vec)
+        | flat_map(repeat)
+        | flat_map([](int n) { return std::vector<int>{n, -n}; })
+        | map_each([](int n) { return n * 10; });
+
+      static_assert(harmony::list<harmony::traits::unwrap_t<decltype(nested)>>);
+      ut::expect(harmony::validate(nested));
+      ut::expect((std::move(nested) | map_to<std::vector<int>>) == std::vector<int>{10, -10, 20, -20, 20, -20, 30, -30, 30, -30, 30, -30});
+    }
     {
-      using namespace std::string_view_literals;
+      // 全ての範囲が空なら無効値になる
+      int calls = 0;
+      auto none = [&calls](int) { ++calls; return std::vector<int>{}; };
 
-      tl::expected<int, std::string> ex{10};
+      auto r = harmony::monas(std::vector<int>{1, 2, 3}) | flat_map(none);
+      ut::expect(not harmony::validate(r));
+      ut::expect(calls == 3_i);
 
-      auto r = harmony::monas(ex)
-        | and_then([](int n) { return tl::expected<int, std::string>{2 * n}; })
-        | and_then([](int n) { return tl::expected<double, std::string>{double(n)};});
+      auto r2 = harmony::monas(std::vector<int>{1, 2, 3})
+        | flat_map(none)
+        | map_each([](int n) { return n + 1; });
+      ut::expect(not harmony::validate(r2));
 
-      !ut::expect(harmony::validate(r));
-      20.0_d == harmony::unwrap(r);
+      auto r3 = harmony::monas(std::vector<int>{1, 2, 3}) | flat_map([](int n) { return std::vector<int>(std::size_t(n == 3), n); });
+      ut::expect(harmony::validate(r3));
+    }
+    {
+      std::array<std::byte, 1024> buffer;
+      std::pmr::monotonic_buffer_resource resource(buffer.data(), buffer.size(), std::pmr::null_memory_resource());
 
-      ex = 20;
-      auto r2 = harmony::monas(ex)
-        | and_then([](int) { return tl::expected<int, std::string>{ tl::unexpect, "failed!"}; })
-        | and_then([](int) { assert(false); return tl::expected<int, std::string>{10};});
+      std::vector<int> vec = {1, 2, 3};
 
-      !ut::expect(not harmony::validate(r2));
-      ut::expect("failed!"sv == harmony::unwrap_other(r2));
+      auto r = harmony::monas(vec)
+        | flat_map([](int n) { return std::array<int, 2>{n, -n}; }, &resource);
+
+      std::pmr::vector<int>& out = r;
+      ut::expect(out == std::pmr::vector<int>{1, -1, 2, -2, 3, -3});
+      ut::expect(out.get_allocator().resource() == &resource);
     }
   };
 
-  "or_else test"_test = [] {
+  "collect test"_test = [] {
     using namespace harmony::monadic_op;
     {
-      auto opt = harmony::monas(std::optional<int>{10}) 
-        | [](int) { return std::nullopt; }
-        | and_then([](int n) { return std::optional<int>{n + 100}; })
-        | or_else([](auto) { return std::optional<double>{1.0};})
-        | [](double d) { return 2.0 * d;};
+      std::vector<std::optional<int>> vec = {1, 2, 3};
 
-      !ut::expect(harmony::validate(opt));
-      2.0_d == harmony::unwrap(opt);
+      auto r = vec | collect<std::vector<int>>;
+      ut::expect(harmony::validate(r));
+      ut::expect(harmony::unwrap(r) == std::vector<int>{1, 2, 3});
 
-      auto success = ~opt
-        | or_else([](auto) { assert(false); return std::optional<double>(1.0); })
-        | or_else([](auto) { assert(false); return std::optional<double>(3.0); });
+      vec.emplace_back(std::nullopt);
+      vec.emplace_back(5);
 
-      ut::expect(harmony::validate(success));
-      2.0_d == harmony::unwrap(success);
+      // eitherでない場合はstd::optional<C>になる
+      std::optional<std::vector<int>> r2 = vec | collect<std::vector<int>>;
+      ut::expect(not r2);
     }
+    {
+      using expected_t = tl::expected<std::string, std::string>;
+
+      std::vector<expected_t> vec = { "a", tl::unexpected<std::string>("first"), "b", tl::unexpected<std::string>("second") };
+
+      // 最初の無効値を返す
+      auto r = harmony::monas(vec) | collect<std::vector<std::string>>;
+      ut::expect(not harmony::validate(r));
+      ut::expect(harmony::unwrap_other(r) == "first");
+
+      // 範囲を所有している場合、有効値はムーブされる
+      int copies = 0;
+      auto make_source = [&copies] {
+        std::vector<tl::expected<copy_counted_value, int>> src;
+        for (int i = 0; i < 3000; ++i) src.emplace_back(copy_counted_value{&copies});
+        copies = 0;
+        return src;
+      };
+
+      auto r2 = harmony::monas(make_source()) | collect<std::list<copy_counted_value>>;
+      ut::expect(harmony::unwrap(r2).size() == 3000_ul);
+      ut::expect(0_i == copies);
+
+      auto r3 = harmony::monas(make_source()) | par_collect<std::vector<copy_counted_value>>(1000);
+      ut::expect(harmony::unwrap(r3).size() == 3000_ul);
+      ut::expect(0_i == copies);
 
+      // 左辺値の範囲はコピーされる
+      auto src = make_source();
+      auto r4 = src | collect<std::vector<copy_counted_value>>;
+      ut::expect(3000_i == copies);
+    }
     {
-      using namespace std::string_view_literals;
+      std::vector<std::optional<int>> vec(100000);
+      std::iota(vec.begin(), vec.end(), 0);
 
-      tl::expected<int, std::string_view> ex{tl::unexpect, "expected failed test"};
+      auto r = vec | par_collect<std::vector<int>>(1000);
+      ut::expect(harmony::validate(r));
+      ut::expect(harmony::unwrap(r).size() == vec.size());
+      ut::expect(99999_i == harmony::unwrap(r).back());
 
-      auto r = harmony::monas(ex)
-        | or_else([](std::string_view str) { return tl::expected<int, std::string_view>{tl::unexpect, str.substr(0, 15)}; })
-        | or_else([](std::string_view str) { return tl::expected<int, std::string_view>{tl::unexpect, str.substr(9, 6)}; });
+      using expected_t = tl::expected<int, int>;
+      std::vector<expected_t> evec(100000);
+      std::iota(evec.begin(), evec.end(), 0);
+      evec[70000] = tl::unexpected<int>(7);
+      evec[30000] = tl::unexpected<int>(3);
+      evec[90000] = tl::unexpected<int>(9);
 
-      !ut::expect(not harmony::validate(r));
-      ut::expect("failed"sv == harmony::unwrap_other(r));
+      // 並列化しても、最も前にある無効値を返す
+      auto r2 = evec | par_collect<std::vector<int>>(1000);
+      ut::expect(not harmony::validate(r2));
+      ut::expect(3_i == harmony::unwrap_other(r2));
 
-      auto r2 = harmony::monas(tl::expected<int, std::string_view>{tl::unexpect, "failed"sv})
-        | or_else([](std::string_view) { return tl::expected<int, std::string_view>{20}; })
-        | or_else([](std::string_view) { assert(false); return tl::expected<int, std::string_view>{0};});
+      auto r3 = evec | collect<std::vector<int>>;
+      ut::expect(3_i == harmony::unwrap_other(r3));
+    }
+    {
+      // std::vector<bool>は要素ごとに並列に書き込めないため、詰めるのは1スレッドで行う
+      std::vector<std::optional<bool>> vec(100000);
+      for (std::size_t i = 0; i < vec.size(); ++i) vec[i] = (i % 3 == 0);
 
-      !ut::expect(harmony::validate(r2));
-      20_i == harmony::unwrap(r2);
+      auto r = vec | par_collect<std::vector<bool>>(1000);
+      ut::expect(harmony::validate(r));
+      ut::expect(std::ranges::equal(harmony::unwrap(r), vec | std::views::transform([](const auto& b) { return *b; })));
     }
   };
 
-  "match test"_test = [] {
+  "partition_results test"_test = [] {
     using namespace harmony::monadic_op;
-
+    using expected_t = tl::expected<int, std::string>;
     {
-      int n = 10;
+      std::vector<expected_t> vec = { 1, tl::unexpected<std::string>("a"), 2, 3, tl::unexpected<std::string>("b") };
 
-      int r = harmony::monas(&n)
-        | match([](int n){ return 2*n;}, [](std::nullptr_t) { assert(false); return 0;});
+      std::vector<int> values;
+      std::vector<std::string> errors;
+      values.reserve(vec.size());
+      errors.reserve(vec.size());
 
-      20_i == r;
+      auto [valid, invalid] = vec | partition_results(values, errors);
 
-      int *p = nullptr;
+      ut::expect(valid == 3);
+      ut::expect(invalid == 2);
+      ut::expect(values == std::vector<int>{1, 2, 3});
+      ut::expect(errors == std::vector<std::string>{"a", "b"});
+
+      // 出力先の末尾に追加される
+      auto count = harmony::monas(vec) | partition_results(values, errors);
+      ut::expect(count.valid == 3);
+      ut::expect(values.size() == 6);
+      ut::expect(errors.size() == 4);
+    }
+    {
+      std::vector<expected_t> vec(100000);
+      for (std::size_t i = 0; i < vec.size(); ++i) {
+        if (i % 3 == 0) {
+          vec[i] = tl::unexpected<std::string>(std::to_string(i));
+        } else {
+          vec[i] = int(i);
+        }
+      }
+
+      std::vector<int> values = {-1};
+      std::vector<std::string> errors;
+
+      auto count = vec | par_partition_results(values, errors, 1000);
+
+      ut::expect(count.invalid == 33334);
+      ut::expect(count.valid == 66666);
+      ut::expect(values.size() == 66667);
+
+      // 元の順序が保たれる
+      ut::expect(std::ranges::is_sorted(values));
+      ut::expect(errors[1] == "3");
+      ut::expect(errors.back() == "99999");
+    }
+    {
+      // std::vector<bool>の出力先には、チャンクの結果を1スレッドで連結する
+      std::vector<tl::expected<bool, int>> vec(100000);
+      for (std::size_t i = 0; i < vec.size(); ++i) {
+        if (i % 5 == 0) {
+          vec[i] = tl::unexpected<int>(int(i));
+        } else {
+          vec[i] = (i % 2 == 0);
+        }
+      }
+
+      std::vector<bool> values;
+      std::vector<int> errors;
+
+      auto count = vec | par_partition_results(values, errors, 1000);
+
+      ut::expect(count.valid == 80000);
+      ut::expect(count.invalid == 20000);
+      ut::expect(values[0] == false and values[1] == true and values[2] == false);
+      ut::expect(errors.back() == 99995_i);
+    }
+  };
+
+  "either_vector test"_test = [] {
+    using namespace harmony::monadic_op;
+    using ev_t = harmony::either_vector<std::string, int>;
+
+    static_assert(harmony::list<ev_t>);
+    static_assert(std::ranges::random_access_range<ev_t>);
+    static_assert(harmony::either<ev_t::reference>);
+
+    {
+      ev_t ev;
+      ev.emplace_value(1);
+      ev.emplace_error("a");
+      ev.push_back(tl::expected<int, std::string>{2});
+      ev.push_back(tl::expected<int, std::string>{tl::unexpect, "b"});
+      ev.emplace_value(3);
+
+      ut::expect(ev.size() == 5_ul);
+      ut::expect(ev.values().size() == 3_ul);
+      ut::expect(ev.errors().size() == 2_ul);
+      ut::expect(ev.valid(0) and not ev.valid(1) and ev.valid(2) and not ev.valid(3) and ev.valid(4));
+      ut::expect(2_i == *ev[2]);
+      ut::expect(3_i == *ev[4]);
+      ut::expect(ev[3].unwrap_err() == "b");
+
+      // 有効値にだけ適用される
+      harmony::monas(ev) | [](int n) { return n * 10; };
+
+      ut::expect(10_i == *ev[0]);
+      ut::expect(20_i == *ev[2]);
+      ut::expect(30_i == *ev[4]);
+      ut::expect(ev[1].unwrap_err() == "a");
+
+      std::vector<std::size_t> indices;
+      int sum = 0;
+      ev.for_each_valid([&](std::size_t i, int& n) {
+        indices.push_back(i);
+        sum += n;
+      });
+      ut::expect(indices == std::vector<std::size_t>{0, 2, 4});
+      ut::expect(60_i == sum);
+
+      // イテレータ経由でもeitherとして扱える
+      std::size_t invalid = 0;
+      for (auto e : ev) {
+        if (not harmony::cpo::validate(e)) ++invalid;
+      }
+      ut::expect(invalid == 2_ul);
+    }
+    {
+      // ワード境界をまたぐ
+      harmony::either_vector<int, double> ev;
+      ev.reserve(1000, 0.5);
+      for (int i = 0; i < 1000; ++i) {
+        if (i % 3 == 0) {
+          ev.emplace_error(i);
+        } else {
+          ev.emplace_value(double(i));
+        }
+      }
+
+      harmony::monas(ev) | [](double d) { return d + 0.5; };
+
+      ut::expect(ev.values().size() == 666_ul);
+      ut::expect(998.5_d == *ev[998]);
+      ut::expect(999_i == ev[999].unwrap_err());
+      ut::expect(127.5_d == *ev[127]);
+      ut::expect(129_i == ev[129].unwrap_err());
+
+      ev.clear();
+      ut::expect(ev.empty());
+    }
+  };
+
+  "nullable_column test"_test = [] {
+    using namespace harmony::monadic_op;
+    using column_t = harmony::nullable_column<double>;
+
+    static_assert(harmony::list<column_t>);
+    static_assert(std::ranges::random_access_range<column_t>);
+    static_assert(harmony::maybe<column_t::reference>);
+
+    {
+      std::vector<std::optional<double>> vec = { 1.0, std::nullopt, 3.0, std::nullopt, 5.0 };
+      column_t col(vec);
+
+      ut::expect(col.size() == 5_ul);
+      ut::expect(col.null_count() == 2_ul);
+      ut::expect(col.is_valid(0) and not col.is_valid(1) and col.is_valid(2));
+      ut::expect(3.0_d == *col[2]);
+
+      // Arrowと同じビットマップ
+      ut::expect(col.validity_bitmap().size() == 1_ul);
+      ut::expect(col.validity_bitmap()[0] == std::byte{0b10101});
+
+      harmony::monas(col) | [](double d) { return d * 2.0; };
+
+      ut::expect(2.0_d == *col[0]);
+      ut::expect(6.0_d == *col[2]);
+      ut::expect(10.0_d == *col[4]);
+
+      ut::expect(col | exists([](double d) { return d == 6.0; }));
+      ut::expect(not (col | exists([](double d) { return d == 0.0; })));
+
+      auto filled = harmony::monas(col) | value_or(-1.0);
+      ut::expect(filled == std::vector<double>{2.0, -1.0, 6.0, -1.0, 10.0});
+
+      auto back = harmony::monas(col) | fold_to<std::vector<std::optional<double>>>;
+      ut::expect(back == std::vector<std::optional<double>>{2.0, std::nullopt, 6.0, std::nullopt, 10.0});
+
+      auto zeros = harmony::monas(col) | fold_to<std::vector<double>>;
+      ut::expect(zeros == std::vector<double>{2.0, 0.0, 6.0, 0.0, 10.0});
+
+      col.set_null(0);
+      ut::expect(col.null_count() == 3_ul);
+      ut::expect(not (col | exists([](double d) { return d == 2.0; })));
+    }
+    {
+      // ワード境界をまたぐ、全て有効なワードと全て無効なワードを含む
+      harmony::nullable_column<int> col;
+      col.reserve(300);
+      for (int i = 0; i < 300; ++i) {
+        if (i < 64 or (128 <= i and i < 192) or (i >= 192 and i % 5 == 0)) {
+          col.push_back(i);
+        } else {
+          col.push_null();
+        }
+      }
+
+      harmony::monas(col) | [](int n) { return n + 1; };
+
+      int sum = 0;
+      std::size_t valid = 0;
+      for (auto m : col) {
+        if (m) {
+          sum += *m;
+          ++valid;
+        }
+      }
+
+      ut::expect(valid + col.null_count() == 300_ul);
+      ut::expect(1_i == *col[0]);
+      ut::expect(64_i == *col[63]);
+      ut::expect(not col.is_valid(64));
+      ut::expect(130_i == *col[129]);
+      ut::expect(296_i == *col[295]);
+      ut::expect(col | exists([](int n) { return n == 296; }));
+      ut::expect(not (col | exists([](int n) { return n == 100; })));
+
+      auto copy = col;
+      ut::expect(copy.size() == 300_ul);
+      ut::expect(sum > 0);
+    }
+  };
+
+  "validity query test"_test = [] {
+    using namespace harmony::monadic_op;
+    {
+      std::vector<std::optional<int>> vec(1000, 1);
+      vec[300] = std::nullopt;
+      vec[700] = std::nullopt;
+
+      ut::expect((vec | count_valid) == 998_ul);
+      ut::expect(not (vec | all_valid));
+      ut::expect(vec | any_valid);
+      ut::expect((vec | first_invalid) == vec.begin() + 300);
+      ut::expect((harmony::monas(vec) | count_valid) == 998_ul);
+      ut::expect((harmony::monas(vec) | first_invalid) == vec.begin() + 300);
+
+      ut::expect(vec | exists([](const std::optional<int>& x) { return not x; }));
+      ut::expect(not (vec | exists([](const std::optional<int>& x) { return x == 2; })));
+
+      std::vector<std::optional<int>> none(10);
+      ut::expect((none | count_valid) == 0_ul);
+      ut::expect(not (none | any_valid));
+      ut::expect((none | first_invalid) == none.begin());
+    }
+    {
+      // NaNを無効値とみなす
+      std::vector<double> vec(600, 1.0);
+      ut::expect(vec | all_valid);
+      ut::expect((vec | first_invalid) == vec.end());
+
+      vec[599] = std::numeric_limits<double>::quiet_NaN();
+      ut::expect((vec | count_valid) == 599_ul);
+      ut::expect(not (vec | all_valid));
+      ut::expect((vec | first_invalid) == vec.end() - 1);
+    }
+    {
+      int n = 0;
+      std::vector<int*> vec = { &n, &n, nullptr, &n };
+      ut::expect((vec | count_valid) == 3_ul);
+      ut::expect((vec | first_invalid) == vec.begin() + 2);
+
+      // 連続範囲でない場合
+      std::list<int*> list(vec.begin(), vec.end());
+      ut::expect((list | count_valid) == 3_ul);
+      ut::expect(not (list | all_valid));
+      ut::expect((list | first_invalid) == std::next(list.begin(), 2));
+    }
+    {
+      harmony::nullable_column<int> col;
+      for (int i = 0; i < 200; ++i) col.push_back(i);
+
+      ut::expect(col | all_valid);
+      ut::expect((col | count_valid) == 200_ul);
+      ut::expect((col | first_invalid) == col.end());
+
+      col.set_null(130);
+      ut::expect(not (col | all_valid));
+      ut::expect((col | count_valid) == 199_ul);
+      ut::expect((col | first_invalid) == col.begin() + 130);
+    }
+  };
+
+  "trace test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    // 無効なポリシーでは何も保持しない
+    static_assert(sizeof(harmony::traced<std::optional<int>, harmony::no_trace>) == sizeof(harmony::monas<std::optional<int>>));
+
+    {
+      harmony::trace_recorder rec;
+
+      int r = harmony::trace(std::optional<int>{10}, rec)
+        | [](int n) { return n * 2; }
+        | and_then([](int n) -> std::optional<int> { if (n > 10) return std::nullopt; return n; })
+        | [](int n) { return n + 1; }
+        | value_or(-1);
+
+      ut::expect(-1_i == r);
+
+      auto events = rec.events();
+      ut::expect(events.size() == 4_ul);
+      ut::expect(events[0].stage == 0_ul);
+      ut::expect(events[3].stage == 3_ul);
+      ut::expect(events[0].valid and not events[0].short_circuited);
+      ut::expect(not events[1].valid and not events[1].short_circuited);
+      ut::expect(not events[2].valid and events[2].short_circuited);
+      // value_orは入力によらず処理を行う
+      ut::expect(not events[3].input_valid and not events[3].short_circuited);
+      ut::expect(rec.failed_stage() == std::optional<std::size_t>{1});
+    }
+    {
+      // エラー側の処理は、入力が無効値の時に呼ばれ、有効値の時に短絡される
+      harmony::trace_recorder rec;
+      int calls = 0;
+
+      int r = harmony::trace(std::optional<int>{}, rec)
+        | or_else([&calls](auto) { ++calls; return std::optional<int>{1}; })
+        | or_else([&calls](auto) { ++calls; return std::optional<int>{2}; })
+        | [](int n) { return n + 1; }
+        | value_or(0);
+
+      ut::expect(2_i == r);
+      ut::expect(1_i == calls);
+
+      auto events = rec.events();
+      ut::expect(events.size() == 4_ul);
+      ut::expect(not events[0].input_valid and not events[0].short_circuited and events[0].valid);
+      ut::expect(events[1].input_valid and events[1].short_circuited);
+      ut::expect(events[2].input_valid and not events[2].short_circuited);
+      ut::expect(not rec.failed_stage());
+    }
+    {
+      harmony::trace_recorder rec;
+      tl::expected<int, std::string> ex = tl::unexpected<std::string>("error");
+
+      auto m = harmony::trace(ex, rec)
+        | map_err([](const std::string& s) { return s.size(); })
+        | [](int n) { return n + 1; }
+        | map_err([](std::size_t n) { return n * 2; });
+
+      auto events = rec.events();
+      ut::expect(events.size() == 3_ul);
+      ut::expect(not events[0].input_valid and not events[0].short_circuited and not events[0].valid);
+      ut::expect(events[1].short_circuited);
+      ut::expect(not events[2].short_circuited);
+      // 無効値のまま変換しただけのステージは失敗とみなさない
+      ut::expect(not rec.failed_stage());
+
+      tl::expected<int, std::size_t> u = std::move(m).untraced();
+      ut::expect(10_ul == u.error());
+    }
+    {
+      harmony::trace_recorder rec;
+      int n = 1;
+
+      harmony::trace(&n, rec) | [](int m) { return m + 1; } | [](int m) { return m * 3; };
+
+      ut::expect(6_i == n);
+      ut::expect(rec.events().size() == 2_ul);
+      ut::expect(not rec.failed_stage());
+    }
+    {
+      tl::expected<int, std::string> ex{1};
+
+      auto m = harmony::trace(ex) | [](int n) { return n + 1; } | map_err([](const std::string& s) { return s.size(); });
+      harmony::monas<tl::expected<int, std::size_t>> u = std::move(m).untraced();
+
+      ut::expect(u);
+      ut::expect(2_i == *u);
+    }
+  };
+
+#ifdef __cpp_lib_source_location
+
+  "funnel test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    auto run = [](std::optional<int> x) {
+      return harmony::funnel(x)
+        | [](int n) { return n + 1; }
+        | and_then([](int n) -> std::optional<int> { if (n % 2 == 0) return n; return std::nullopt; })
+        | [](int n) { return n * 10; }
+        | value_or(-1);
+    };
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+      threads.emplace_back([&run] {
+        for (int i = 0; i < 1000; ++i) {
+          // 1/10は最初から無効、残りの半分がステージ1で無効になる
+          run(i % 10 == 0 ? std::nullopt : std::optional<int>{i});
+        }
+      });
+    }
+    for (auto& th : threads) th.join();
+
+    auto reports = harmony::funnel_report();
+    auto it = std::ranges::find_if(reports, [](const auto& r) { return std::string_view(r.file).ends_with("harmony_test.cpp"); });
+
+    ut::expect(it != reports.end());
+    ut::expect(it->entered == 4000_ul);
+    ut::expect(it->stages.size() == 4_ul);
+    ut::expect(it->stages[0].reached == 3600_ul);
+    ut::expect(it->stages[0].failed == 0_ul);
+    ut::expect(it->stages[1].reached == 3600_ul);
+    ut::expect(it->stages[1].failed == 1600_ul);
+    ut::expect(it->stages[2].reached == 2000_ul);
+    ut::expect(it->stages[3].reached == 2000_ul);
+
+    const auto dump = harmony::funnel_dump();
+    ut::expect(dump.find("harmony_funnel_entered{site=\"") != std::string::npos);
+    ut::expect(dump.find("stage=\"1\"} 1600\n") != std::string::npos);
+
+    // # TYPE行はメトリクス毎に1つだけ、その値より前に出力される
+    for (std::string_view name : {"harmony_funnel_entered", "harmony_funnel_reached", "harmony_funnel_failed"}) {
+      const std::string type = "# TYPE " + std::string(name) + " counter\n";
+      const auto pos = dump.find(type);
+      ut::expect(pos != std::string::npos);
+      ut::expect(dump.find(type, pos + 1) == std::string::npos);
+      ut::expect(pos < dump.find(std::string(name) + "{"));
+    }
+
+    {
+      // ラベル値のバックスラッシュ・ダブルクォート・改行はエスケープされる
+      std::string label;
+      harmony::detail::append_label_value(label, "C:\\src\\\"a\"\nb.cpp");
+      ut::expect(label == "C:\\\\src\\\\\\\"a\\\"\\nb.cpp");
+    }
+
+    // 終了したスレッドのカウンタは、後から開始したスレッドが再利用する
+    auto count_blocks = [](const char* file, std::uint_least32_t line) {
+      std::size_t n = 0;
+      for (auto* site = harmony::detail::funnel_registry.load(); site != nullptr; site = site->next) {
+        if (site->file != file or site->line != line) continue;
+        for (auto* c = site->counters.load(); c != nullptr; c = c->next) ++n;
+      }
+      return n;
+    };
+    const std::size_t blocks = count_blocks(it->file, it->line);
+    for (int t = 0; t < 4; ++t) {
+      std::thread([&run] { run(1); }).join();
+    }
+    ut::expect(count_blocks(it->file, it->line) == blocks);
+    ut::expect(harmony::funnel_report().size() == reports.size());
+
+    {
+      funnel_in_template<int>(1);
+      funnel_in_template<int>(std::nullopt);
+      funnel_in_template<long>(1);
+
+      auto in_template = harmony::funnel_report();
+      std::erase_if(in_template, [](const auto& r) { return std::string_view(r.function).find("funnel_in_template") == std::string_view::npos; });
+
+      ut::expect(in_template.size() == 2_ul);
+      for (const auto& r : in_template) {
+        const bool is_int = std::string_view(r.function).find("long") == std::string_view::npos;
+        ut::expect(r.entered == (is_int ? 2_ul : 1_ul));
+      }
+    }
+  };
+
+#endif
+
+  "pipeline test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    {
+      // 状態を持たない処理だけからなるパイプラインは空
+      auto p = map([](int n) { return n + 1; })
+            >> and_then([](int n) -> tl::expected<int, int> { if (n % 2 == 0) return n; return tl::unexpected(n); })
+            >> map_err([](int e) { return e * 100; });
+
+      static_assert(std::is_empty_v<decltype(p)>);
+
+      tl::expected<int, int> ok = 1;
+      tl::expected<int, int> ng = 2;
+      tl::expected<int, int> err = tl::unexpected(-1);
+
+      tl::expected<int, int> r1 = ok | p;
+      tl::expected<int, int> r2 = ng | p;
+      tl::expected<int, int> r3 = err | p;
+
+      ut::expect(r1 == 2);
+      ut::expect(r2 == tl::expected<int, int>(tl::unexpected(300)));
+      ut::expect(r3 == tl::expected<int, int>(tl::unexpected(-100)));
+
+      // 同じパイプラインを何度でも適用できる
+      int sum = 0;
+      for (int i = 0; i < 10; ++i) {
+        tl::expected<int, int> r = tl::expected<int, int>(i) | p;
+        sum += r.value_or(0);
+      }
+      ut::expect(sum == 30_i);
+    }
+    {
+      // 処理でない関数はbindとして扱われ、パイプライン同士は平坦に連結される
+      auto head = [](int n) { return n * 2; } >> map([](int n) { return n + 1; });
+      auto tail = exists([](int n) { return 10 < n; });
+      auto p = head >> [](int n) { return n * 3; } >> tail;
+
+      static_assert(std::tuple_size<std::remove_cvref_t<decltype(p.stages())>>::value == 4);
+
+      ut::expect((std::optional<int>{1} | p) == false);
+      ut::expect((std::optional<int>{2} | p) == true);
+      ut::expect((std::optional<int>{} | p) == false);
+
+      // 直接チェーンした場合と同じ結果になる
+      auto direct = harmony::monas(std::optional<int>{3}) | [](int n) { return n * 2; } | map([](int n) { return n + 1; }) | [](int n) { return n * 3; } | value_or(0);
+      auto piped = std::optional<int>{3} | (head >> [](int n) { return n * 3; } >> value_or(0));
+      ut::expect(direct == piped);
+    }
+    {
+      // 関数の状態は適用のたびにコピーされない
+      int copies = 0;
+      struct counted {
+        int* copies;
+        counted(int* c) : copies(c) {}
+        counted(const counted& other) : copies(other.copies) { ++*copies; }
+        auto operator()(int n) const -> int { return n + 1; }
+      };
+
+      auto p = map(counted{&copies}) >> map(counted{&copies});
+      const int base = copies;
+
+      for (int i = 0; i < 100; ++i) {
+        auto r = std::optional<int>{i} | p | value_or(0);
+        ut::expect(r == i + 2);
+      }
+      ut::expect(copies == base);
+    }
+    {
+      // 複数の関数を持つ処理やvalue_or_else、then_onも適用のたびにコピーされない
+      int copies = 0;
+      auto f = [&copies] { return copy_counted<int>{&copies}; };
+      auto pred = [&copies] { return copy_counted<bool>{&copies}; };
+
+      const auto p1 = map(f()) >> value_or_else(f());
+      const auto p2 = fused(f(), f()) >> value_or(0);
+      const auto p3 = map(f()) >> match(f(), f());
+      const auto p4 = map(f()) >> for_all(pred());
+      const auto p5 = map(f()) >> par_exists(pred());
+      const auto p6 = map(f()) >> par_for_all(pred());
+      const auto p7 = par_then(f()) >> par_then(f());
+      const auto p8 = map(f()) >> then_on(harmony::inline_executor{}, f());
+      const int base = copies;
+
+      for (int i = 0; i < 10; ++i) {
+        ut::expect((std::optional<int>{i} | p1) == 1_i);
+        ut::expect((std::optional<int>{i} | p2) == 1_i);
+        ut::expect((tl::expected<int, int>{i} | p3) == 1_i);
+        ut::expect(std::optional<int>{i} | p4);
+        ut::expect(std::optional<int>{i} | p5);
+        ut::expect(std::optional<int>{i} | p6);
+        ut::expect(std::ranges::equal(*(std::vector<int>{i, i} | p7), std::vector<int>{1, 1}));
+        ut::expect(harmony::unwrap((std::optional<int>{i} | p8).get()) == 1_i);
+      }
+      ut::expect(copies == base);
+    }
+    {
+      // traceしたチェーンにもパイプラインを適用できる
+      harmony::trace_recorder rec;
+      int r = harmony::trace(std::optional<int>{1}, rec) | (map([](int n) { return n + 1; }) >> value_or(0));
+      ut::expect(r == 2_i);
+      ut::expect(rec.events().size() == 1_ul);
+    }
+    {
+      // constで呼び出し可能な関数からなるパイプラインは、複数スレッドから同時に適用できる
+      const std::vector<int> table = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+      const auto p = map([&table](int n) { return table[n % table.size()]; }) >> value_or(0);
+
+      std::vector<long long> sums(4);
+      std::vector<std::thread> threads;
+      for (std::size_t t = 0; t < sums.size(); ++t) {
+        threads.emplace_back([&p, &sums, t] {
+          for (int i = 0; i < 1000; ++i) {
+            sums[t] += std::optional<int>{i} | p;
+          }
+        });
+      }
+      for (auto& th : threads) th.join();
+
+      for (auto s : sums) {
+        ut::expect(s == 5500);
+      }
+    }
+  };
+
+  "thread_pool test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    {
+      std::atomic<int> count = 0;
+      {
+        harmony::thread_pool pool{4};
+        ut::expect(pool.size() == 4_ul);
+
+        for (int i = 0; i < 100; ++i) {
+          pool.execute([&pool, &count] {
+            // ワーカー上から投げた処理は、そのワーカーのキューに積まれる
+            for (int j = 0; j < 10; ++j) {
+              pool.execute([&count] { count.fetch_add(1); });
+            }
+            count.fetch_add(1);
+          });
+        }
+        // デストラクタは残った処理を全て実行してから終了する
+      }
+      ut::expect(count.load() == 1100_i);
+    }
+    {
+      // 1つのワーカーのキューに積まれた処理を、もう1つのワーカーが盗んで実行する
+      std::atomic<int> stolen = 0;
+      {
+        harmony::thread_pool pool{2};
+
+        pool.execute([&] {
+          const auto owner = std::this_thread::get_id();
+          for (int i = 0; i < 8; ++i) {
+            pool.execute([&stolen, owner] {
+              if (std::this_thread::get_id() != owner) stolen.fetch_add(1);
+            });
+          }
+          // このワーカーが待機している間、積んだ処理は他のワーカーしか実行できない
+          const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+          while (stolen.load() == 0 and std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+          }
+        });
+      }
+      ut::expect(0 < stolen.load());
+    }
+    {
+      harmony::thread_pool pool{2};
+
+      std::future<std::optional<int>> f1 = std::optional<int>{10} | then_on(pool, [](int n) { return n * 2; });
+      std::future<std::optional<int>> f2 = std::optional<int>{} | then_on(pool, [](int n) { return n * 2; });
+      std::future<harmony::sachet<std::nullopt_t, double>> f3 = std::optional<int>{3} | map_on(pool, [](int n) { return n * 0.5; });
+
+      ut::expect(f1.get() == 20);
+      ut::expect(f2.get() == std::nullopt);
+      ut::expect(harmony::unwrap(f3.get()) == 1.5_d);
+
+      // 左辺値は書き換えられない
+      std::optional<int> x = 5;
+      auto f4 = harmony::monas(x) | then_on(pool, [](int n) { return n + 1; });
+      ut::expect(f4.get() == 6);
+      ut::expect(x == 5);
+
+      // 結果はfuture-likeなので、そのままmonasに渡せる
+      auto f5 = std::optional<int>{1} | then_on(pool, [](int n) { return n + 1; });
+      int r = harmony::monas(std::move(f5)) | map([](std::optional<int> n) { return n.value_or(0) * 10; })
+                                            | map_err([](auto) { return -1; })
+                                            | fold_to<int>;
+      ut::expect(r == 20_i);
+
+      // listは要素ごとにbindされる
+      std::vector<int> vec = {1, 2, 3};
+      auto f6 = vec | then_on(pool, [](int n) { return n * n; });
+      ut::expect(f6.get() == std::vector<int>{1, 4, 9});
+      ut::expect(vec == std::vector<int>{1, 2, 3});
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      harmony::thread_pool pool{1};
+      auto f = std::optional<int>{1} | then_on(pool, [](int) -> int { throw std::runtime_error("error"); });
+
+      bool thrown = false;
+      try {
+        f.get();
+      } catch (const std::runtime_error&) {
+        thrown = true;
+      }
+      ut::expect(thrown);
+    }
+#endif
+  };
+
+  "when_all/when_any test"_test = [] {
+    using namespace harmony::monadic_op;
+    using namespace std::chrono_literals;
+
+    {
+      auto f1 = std::async(std::launch::async, [] { std::this_thread::sleep_for(20ms); return 1; });
+      auto f2 = std::async(std::launch::async, [] { return std::string("two"); });
+      int n = 3;
+      std::promise<int&> p3;
+      p3.set_value(n);
+
+      harmony::specialization_of<harmony::monas> auto m = harmony::when_all(std::move(f1), std::move(f2), p3.get_future());
+      ut::expect(harmony::validate(m));
+
+      auto [a, b, c] = harmony::unwrap(m);
+      ut::expect(a == 1_i);
+      ut::expect(b == "two");
+      ut::expect(&c.get() == &n);
+
+      int r = harmony::when_all(std::async([] { return 10; }), std::async([] { return 20; }))
+        | map([](const auto& t) { return std::get<0>(t) + std::get<1>(t); })
+        | map_err([](auto) { return -1; })
+        | fold_to<int>;
+      ut::expect(r == 30_i);
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      auto f1 = std::async(std::launch::async, [] { return 1; });
+      auto f2 = std::async(std::launch::async, []() -> int { throw std::runtime_error("first"); });
+      auto f3 = std::async(std::launch::async, []() -> int { throw std::logic_error("second"); });
+
+      auto m = harmony::when_all(std::move(f1), std::move(f2), std::move(f3));
+      ut::expect(not harmony::validate(m));
+
+      // 引数順で最初の例外が保持される
+      bool first = false;
+      try {
+        std::rethrow_exception(harmony::unwrap_other(m));
+      } catch (const std::runtime_error&) {
+        first = true;
+      } catch (...) {}
+      ut::expect(first);
+    }
+#endif
+    {
+      std::promise<int> p1;
+      std::promise<std::string> p2;
+      auto f1 = p1.get_future();
+      auto f2 = p2.get_future();
+
+      std::jthread th([&p2] {
+        std::this_thread::sleep_for(10ms);
+        p2.set_value("ready");
+      });
+
+      auto m = harmony::when_any(f1, f2);
+      ut::expect(harmony::validate(m));
+
+      auto& v = harmony::unwrap(m);
+      ut::expect(v.index() == 1_ul);
+      ut::expect(std::get<1>(v) == "ready");
+
+      // 選ばれなかったfutureはそのまま残る
+      ut::expect(f1.valid());
+      p1.set_value(5);
+      ut::expect(f1.get() == 5_i);
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      std::promise<int> p1;
+      std::promise<int> p2;
+      p2.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+
+      auto f1 = p1.get_future();
+      auto m = harmony::when_any(f1, p2.get_future());
+      ut::expect(not harmony::validate(m));
+    }
+#endif
+    {
+      // when_allでも、無効なfutureはget()せずに無効値になる
+      std::promise<int> p1;
+      p1.set_value(1);
+      std::future<int> empty;
+
+      auto m = harmony::when_all(p1.get_future(), empty);
+      ut::expect(not harmony::validate(m));
+#ifndef HARMONY_NO_EXCEPTIONS
+      try {
+        std::rethrow_exception(harmony::unwrap_other(m));
+      } catch (const std::future_error& ex) {
+        ut::expect(ex.code() == std::future_errc::no_state);
+      }
+#endif
+    }
+    {
+      // 無効なfutureはget()せずに無効値になる
+      std::promise<int> p1;
+      auto f1 = p1.get_future();
+      std::future<int> empty;
+
+      auto m = harmony::when_any(f1, empty);
+      ut::expect(not harmony::validate(m));
+#ifndef HARMONY_NO_EXCEPTIONS
+      try {
+        std::rethrow_exception(harmony::unwrap_other(m));
+      } catch (const std::future_error& ex) {
+        ut::expect(ex.code() == std::future_errc::no_state);
+      }
+#endif
+    }
+    {
+      // 待機していない入力の準備ができても検出される
+      std::array<std::promise<int>, 6> ps;
+      std::array<std::future<int>, 6> fs;
+      for (std::size_t i = 0; i < ps.size(); ++i) fs[i] = ps[i].get_future();
+
+      std::jthread th([&ps] {
+        std::this_thread::sleep_for(5ms);
+        ps[4].set_value(4);
+      });
+
+      auto m = harmony::when_any(fs[0], fs[1], fs[2], fs[3], fs[4], fs[5]);
+      ut::expect(harmony::validate(m));
+      ut::expect(harmony::unwrap(m).index() == 4_ul);
+    }
+  };
+
+  "with_deadline/until test"_test = [] {
+    using namespace harmony::monadic_op;
+    using namespace std::chrono_literals;
+
+    {
+      std::promise<int> p;
+      auto f = p.get_future();
+
+      // 期限切れ
+      auto m = harmony::with_deadline(f, 1ms);
+      ut::expect(not harmony::validate(m));
+      ut::expect(std::holds_alternative<harmony::deadline_exceeded>(harmony::unwrap_other(m)));
+      ut::expect(f.valid());
+
+      // 期限内
+      p.set_value(10);
+      int r = harmony::with_deadline(f, 1s)
+        | map([](int n) { return n * 2; })
+        | map_err([](const harmony::deadline_error&) { return -1; })
+        | fold_to<int>;
+      ut::expect(r == 20_i);
+    }
+    {
+      std::promise<int> p1;
+      std::promise<int> p2;
+      p2.set_value(2);
+
+      // 1つの期限を共有する
+      const auto deadline = std::chrono::steady_clock::now() + 5ms;
+      auto m1 = harmony::until(p1.get_future(), deadline);
+      auto m2 = harmony::until(p2.get_future(), deadline);
+
+      ut::expect(not harmony::validate(m1));
+      ut::expect(harmony::validate(m2));
+      ut::expect(harmony::unwrap(m2) == 2_i);
+      ut::expect(deadline <= std::chrono::steady_clock::now());
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      std::promise<int> p;
+      p.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+
+      auto m = harmony::with_deadline(p.get_future(), 1s);
+      ut::expect(not harmony::validate(m));
+      ut::expect(std::holds_alternative<std::exception_ptr>(harmony::unwrap_other(m)));
+    }
+#endif
+    {
+      // 無効なfutureはget()せずに無効値になる
+      auto m = harmony::with_deadline(std::future<int>{}, 1ms);
+      ut::expect(not harmony::validate(m));
+      ut::expect(std::holds_alternative<std::exception_ptr>(harmony::unwrap_other(m)));
+#ifndef HARMONY_NO_EXCEPTIONS
+      try {
+        std::rethrow_exception(std::get<std::exception_ptr>(harmony::unwrap_other(m)));
+      } catch (const std::future_error& ex) {
+        ut::expect(ex.code() == std::future_errc::no_state);
+      }
+#endif
+    }
+  };
+
+  "poll_result test"_test = [] {
+    using namespace std::chrono_literals;
+
+    {
+      std::promise<int> p;
+      int called = 0;
+
+      auto r = harmony::poll(p.get_future())
+        | [&called](int n) { ++called; return n * 2; }
+        | [&called](int n) { ++called; return std::to_string(n); };
+
+      static_assert(std::same_as<decltype(r), harmony::poll_result<std::string, std::exception_ptr>>);
+
+      // 準備中は積まれるだけで実行されない
+      ut::expect(r.is_pending());
+      ut::expect(r.poll() == false);
+      ut::expect(called == 0_i);
+
+      p.set_value(21);
+      ut::expect(r.poll());
+      ut::expect(r.has_value());
+      ut::expect(r.value() == "42");
+      ut::expect(called == 2_i);
+
+      // 準備ができた後はその場で適用される
+      auto r2 = std::move(r) | [](const std::string& str) { return str.size(); };
+      ut::expect(r2.has_value());
+      ut::expect(r2.value() == 2_ul);
+    }
+    {
+      // 準備済みのfutureはその場で処理される
+      std::promise<int> p;
+      p.set_value(1);
+      auto r = harmony::poll(p.get_future()) | [](int n) { return n + 1; };
+      ut::expect(r.has_value());
+      ut::expect(r.value() == 2_i);
+    }
+    {
+      // poll_resultを返す関数は平坦化され、非同期処理を繋げられる
+      std::promise<int> p1;
+      std::promise<int> p2;
+      auto f2 = p2.get_future().share();
+
+      auto r = harmony::poll(p1.get_future())
+        | [f2](int n) { return harmony::poll(f2) | [n](int m) { return n + m; }; };
+
+      static_assert(std::same_as<decltype(r), harmony::poll_result<int, std::exception_ptr>>);
+
+      ut::expect(r.poll() == false);
+      p1.set_value(1);
+      ut::expect(r.poll() == false);
+      p2.set_value(10);
+      ut::expect(r.poll());
+      ut::expect(r.value() == 11_i);
+    }
+    {
+      // 1つのスレッドで複数のチェーンを駆動する
+      std::vector<std::promise<int>> promises(3);
+      std::vector<harmony::poll_result<int, std::exception_ptr>> chains;
+      for (auto& p : promises) {
+        chains.push_back(harmony::poll(p.get_future()) | [](int n) { return n * n; });
+      }
+
+      std::jthread producer([&promises] {
+        for (int i = 0; auto& p : promises) {
+          std::this_thread::sleep_for(1ms);
+          p.set_value(++i);
+        }
+      });
+
+      std::size_t done = 0;
+      while (done < chains.size()) {
+        done = 0;
+        for (auto& c : chains) {
+          done += c.poll() ? 1 : 0;
+        }
+        std::this_thread::sleep_for(100us);
+      }
+
+      ut::expect(chains[0].value() == 1_i);
+      ut::expect(chains[1].value() == 4_i);
+      ut::expect(chains[2].value() == 9_i);
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      std::promise<int> p;
+      bool called = false;
+      auto r = harmony::poll(p.get_future()) | [&called](int n) { called = true; return n; };
+
+      p.set_exception(std::make_exception_ptr(std::runtime_error("error")));
+      ut::expect(r.poll());
+      ut::expect(r.has_error());
+      ut::expect(not called);
+    }
+#endif
+    {
+      // 無効なfutureはget()せずにエラーになる
+      bool called = false;
+      auto r = harmony::poll(std::future<int>{}) | [&called](int n) { called = true; return n; };
+      ut::expect(r.has_error());
+      ut::expect(not called);
+#ifndef HARMONY_NO_EXCEPTIONS
+      try {
+        std::rethrow_exception(r.error());
+      } catch (const std::future_error& ex) {
+        ut::expect(ex.code() == std::future_errc::no_state);
+      }
+#endif
+    }
+  };
+
+  "par_exists/for_all test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    std::vector<int> vec(100000);
+    std::iota(vec.begin(), vec.end(), 0);
+
+    // grainを小さくして、並列化される経路を通す
+    for (int target : {0, 50000, 99999}) {
+      ut::expect(vec | par_exists([target](int n) { return n == target; }, 1000));
+    }
+    ut::expect(not (vec | par_exists([](int n) { return n < 0; }, 1000)));
+    ut::expect(not (std::vector<int>{} | par_exists([](int) { return true; }, 1000)));
+
+    ut::expect(vec | par_for_all([](int n) { return 0 <= n; }, 1000));
+    ut::expect(not (vec | par_for_all([](int n) { return n != 77777; }, 1000)));
+    ut::expect(vec | for_all([](int n) { return n < 100000; }));
+    ut::expect(not (vec | for_all([](int n) { return n < 99999; })));
+    ut::expect(std::vector<int>{} | for_all([](int) { return false; }));
+
+    // 並列化できないlist
+    std::list<int> li = {1, 2, 3};
+    ut::expect(li | par_exists([](int n) { return n == 3; }));
+    ut::expect(li | par_for_all([](int n) { return 0 < n; }));
+
+    // maybeな型、無効値に対してfor_allはtrue
+    std::optional<int> opt = 10;
+    std::optional<int> none{};
+    ut::expect(opt | par_exists([](int n) { return n == 10; }));
+    ut::expect(not (none | par_exists([](int) { return true; })));
+    ut::expect(opt | for_all([](int n) { return n == 10; }));
+    ut::expect(not (opt | for_all([](int n) { return n == 0; })));
+    ut::expect(none | for_all([](int) { return false; }));
+    ut::expect(none | par_for_all([](int) { return false; }));
+
+    // 見つかった後、他のワーカーは高々validity_block要素（共有フラグが立つまでの分を含めて2ブロック）で打ち切られる
+    {
+      std::atomic<std::size_t> evaluated = 0;
+      std::atomic<bool> matched = false;
+
+      // 最初のチャンクで見つかるまで、他のチャンクの要素は待機させる
+      auto pred = [&](int n) {
+        evaluated.fetch_add(1, std::memory_order_relaxed);
+        if (n == 10) {
+          matched.store(true);
+          return true;
+        }
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (10 < n and not matched.load() and std::chrono::steady_clock::now() < deadline) {
+          std::this_thread::yield();
+        }
+        return false;
+      };
+
+      ut::expect(vec | par_exists(pred, 1000));
+
+      const std::size_t workers = harmony::detail::hardware_workers();
+      ut::expect(evaluated.load() <= 11 + (workers - 1) * 2 * harmony::detail::validity_block);
+    }
+  };
+
+  "map_err test"_test = [] {
+    using namespace harmony::monadic_op;
+    {
+      int n = 10;
+
+      auto r = harmony::monas(&n) 
+        | [](int n) { return n + n; }
+        | [](int n) { return n + 100; }
+        | map_err([](std::nullptr_t) {assert(false); return nullptr; })
+        | map([](int) { return std::optional<int>{};})
+        | map_err([](std::nullopt_t) { return false;})
+        | map([](int v) { assert(false); return v; });
+
+      !ut::expect(not harmony::validate(r));
+      ut::expect(harmony::unwrap_other(r) == false);
+    } 
+    {
+      auto r = harmony::monas(std::optional<int>{10}) 
+        | [](int n) { return n + n; }
+        | [](int) { return std::nullopt; }
+        | map_err([](std::nullopt_t) { return nullptr;})
+        | map_err([](std::nullptr_t) { return false;})
+        | map([](int n) { assert(false); return n; })
+        | map_err([](bool b) { return std::optional{b};})
+        | map_err([](std::nullopt_t) { assert(false); return std::optional<bool>{true};});
+
+      !ut::expect(harmony::validate(r));
+      ut::expect(harmony::unwrap(r) == false);
+    }
+
+    {
+      using namespace std::string_view_literals;
+
+      tl::expected<int, std::string> ex{10};
+
+      auto r = harmony::monas(ex)
+        | [](int n) { return 2*n; }
+        | [](int) { return tl::expected<int, std::string>{tl::unexpect, "fail test"};}
+        | map_err([](std::string str) { str.append(" map_err"); return str; })  // ここのmap_errでMSVCはこける
+        | map_err([](std::string str) { return str == "fail test map_err"sv;})
+        | map([](int n) { assert(false); return n;});
+
+      !ut::expect(not harmony::validate(r));
+      ut::expect(harmony::unwrap_other(r) == true);
+    }
+  };
+
+  "and_then test"_test = []() {
+    using namespace harmony::monadic_op;
+
+    {
+      auto opt = harmony::monas(std::optional<int>{10}) 
+        | [](int n) { return n + n; }
+        | and_then([](int n) { return std::optional<int>{n + 100}; })
+        | [](int n) { return ++n;}
+        | and_then([](int n) { return std::optional<double>(double(n)); });
+
+      !ut::expect(harmony::validate(opt));
+      121.0_d == harmony::unwrap(opt);
+
+      auto fail = ~opt
+        | [](double) { return std::nullopt; }
+        | and_then([](double d) { assert(false); return std::optional<double>(++d); });
+
+      ut::expect(not harmony::validate(fail));
+    }
+
+    {
+      using namespace std::string_view_literals;
+
+      tl::expected<int, std::string> ex{10};
+
+      auto r = harmony::monas(ex)
+        | and_then([](int n) { return tl::expected<int, std::string>{2 * n}; })
+        | and_then([](int n) { return tl::expected<double, std::string>{double(n)};});
+
+      !ut::expect(harmony::validate(r));
+      20.0_d == harmony::unwrap(r);
+
+      ex = 20;
+      auto r2 = harmony::monas(ex)
+        | and_then([](int) { return tl::expected<int, std::string>{ tl::unexpect, "failed!"}; })
+        | and_then([](int) { assert(false); return tl::expected<int, std::string>{10};});
+
+      !ut::expect(not harmony::validate(r2));
+      ut::expect("failed!"sv == harmony::unwrap_other(r2));
+    }
+  };
+
+  "or_else test"_test = [] {
+    using namespace harmony::monadic_op;
+    {
+      auto opt = harmony::monas(std::optional<int>{10}) 
+        | [](int) { return std::nullopt; }
+        | and_then([](int n) { return std::optional<int>{n + 100}; })
+        | or_else([](auto) { return std::optional<double>{1.0};})
+        | [](double d) { return 2.0 * d;};
+
+      !ut::expect(harmony::validate(opt));
+      2.0_d == harmony::unwrap(opt);
+
+      auto success = ~opt
+        | or_else([](auto) { assert(false); return std::optional<double>(1.0); })
+        | or_else([](auto) { assert(false); return std::optional<double>(3.0); });
+
+      ut::expect(harmony::validate(success));
+      2.0_d == harmony::unwrap(success);
+    }
+
+    {
+      using namespace std::string_view_literals;
+
+      tl::expected<int, std::string_view> ex{tl::unexpect, "expected failed test"};
+
+      auto r = harmony::monas(ex)
+        | or_else([](std::string_view str) { return tl::expected<int, std::string_view>{tl::unexpect, str.substr(0, 15)}; })
+        | or_else([](std::string_view str) { return tl::expected<int, std::string_view>{tl::unexpect, str.substr(9, 6)}; });
+
+      !ut::expect(not harmony::validate(r));
+      ut::expect("failed"sv == harmony::unwrap_other(r));
+
+      auto r2 = harmony::monas(tl::expected<int, std::string_view>{tl::unexpect, "failed"sv})
+        | or_else([](std::string_view) { return tl::expected<int, std::string_view>{20}; })
+        | or_else([](std::string_view) { assert(false); return tl::expected<int, std::string_view>{0};});
+
+      !ut::expect(harmony::validate(r2));
+      20_i == harmony::unwrap(r2);
+    }
+  };
+
+  "error propagation test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    using either_t = harmony::sachet<copy_counted_value, int>;
+
+    auto inc = [](int n) { return n + 1; };
+    auto to_either = [](int n) { return either_t(std::in_place_index<1>, n); };
+    auto pass = [](copy_counted_value&& e) { return std::move(e); };
+
+    {
+      int copies = 0;
+
+      // monasが所有する無効値は、途中で一度もコピーされない
+      int r = harmony::monas(either_t(std::in_place_index<0>, &copies))
+        | map(inc)
+        | and_then(to_either)
+        | map(inc)
+        | map_err(pass)
+        | and_then(to_either)
+        | map(inc)
+        | match(inc, [](copy_counted_value&&) { return -1; });
+
+      ut::expect(-1_i == r);
+      ut::expect(0_i == copies);
+    }
+    {
+      int copies = 0;
+      either_t e(std::in_place_index<0>, &copies);
+
+      // 左辺値から始めると、元のオブジェクトを変更しないために最初の一度だけコピーされる
+      auto r = harmony::monas(e)
+        | map(inc)
+        | and_then(to_either)
+        | map(inc)
+        | map_err(pass)
+        | map(inc);
+
+      ut::expect(not harmony::validate(r));
+      ut::expect(1_i == copies);
+      ut::expect(e.unwrap_err().copies == &copies);
+    }
+  };
+
+  "match test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    {
+      int n = 10;
+
+      int r = harmony::monas(&n)
+        | match([](int n){ return 2*n;}, [](std::nullptr_t) { assert(false); return 0;});
+
+      20_i == r;
+
+      int *p = nullptr;
 
       r = harmony::monas(p)
         | match([](int){ assert(false); return 0;}, [](std::nullptr_t) { return 1;});
@@ -920,8 +2554,19 @@ int main() {
 
       ut::expect(r == false);
     }
+    {
+      // 述語は条件を満たす要素が見つかった時点で呼ばれなくなる
+      std::vector<int> vec(1000);
+      int calls = 0;
+
+      bool r = vec | exists([&calls](int n) { ++calls; return n == 0; });
+
+      ut::expect(r == true);
+      ut::expect(1_i == calls);
+    }
   };
 
+#ifndef HARMONY_NO_EXCEPTIONS
   "try_catch test"_test = [] {
     using namespace harmony::monadic_op;
     using namespace std::string_view_literals;
@@ -953,6 +2598,77 @@ int main() {
     ut::expect(str == "division by zero"sv);
   };
 
+  "try_catch_as test"_test = [] {
+    using namespace harmony::monadic_op;
+    using namespace std::string_view_literals;
+
+    auto parse = [](std::string_view str) -> int {
+      if (str.empty()) throw "empty";
+      return std::stoi(std::string(str));
+    };
+
+    // 例外を投げない処理
+    int n = try_catch_as<std::invalid_argument, std::out_of_range>(parse, "42")
+      | map([](int n) { return n + 1; })
+      | map_to<int>;
+
+    ut::expect(43_i == n);
+
+    // 指定した型の例外は、その型のまま保持される
+    auto r1 = try_catch_as<std::invalid_argument, std::out_of_range>(parse, "abc");
+    ut::expect(not harmony::validate(r1));
+    ut::expect(0_ul == harmony::unwrap_other(r1).index());
+
+    auto r2 = try_catch_as<std::invalid_argument, std::out_of_range>(parse, "99999999999999999999");
+    ut::expect(1_ul == harmony::unwrap_other(r2).index());
+
+    // 指定していない型の例外はexception_ptrになる
+    auto r3 = try_catch_as<std::invalid_argument, std::out_of_range>(parse, "");
+    ut::expect(2_ul == harmony::unwrap_other(r3).index());
+
+    // 先に指定した型が優先され、派生クラスの例外は基底クラスとして保持される
+    auto r4 = try_catch_as<std::logic_error, std::invalid_argument>(parse, "abc");
+    ut::expect(0_ul == harmony::unwrap_other(r4).index());
+
+    // 例外を調べるのに再送出は必要ない
+    auto str = try_catch_as<std::invalid_argument, std::out_of_range>(parse, "abc")
+      | map([](int) { assert(false); return std::string{}; })
+      | map_err([](const auto& err) {
+          return std::visit([]<typename E>(const E& e) -> std::string {
+            if constexpr (std::same_as<E, std::exception_ptr>) {
+              return "unknown";
+            } else {
+              return e.what();
+            }
+          }, err);
+        })
+      | fold_to<std::string>;
+
+    ut::expect(str == "stoi"sv);
+
+    // 型を指定しない場合はtry_catchと同じ
+    auto r5 = try_catch_as<>(parse, "");
+    ut::expect(not harmony::validate(r5));
+    ut::expect(bool(std::get<0>(harmony::unwrap_other(r5))));
+  };
+
+#else
+
+  "try_catch test"_test = [] {
+    using namespace harmony::monadic_op;
+
+    // 例外が無効な場合は、常に有効値を保持する
+    auto r = try_catch([](int n, int m) { return n / m; }, 4, 2);
+    ut::expect(harmony::validate(r));
+    ut::expect(2_i == *r);
+
+    auto r2 = try_catch_as<std::invalid_argument>([](int n) { return n + 1; }, 1);
+    ut::expect(harmony::validate(r2));
+    ut::expect(2_i == *r2);
+  };
+
+#endif
+
   "future test"_test = [] {
     using namespace harmony::monadic_op;
     using namespace std::chrono_literals;
@@ -970,6 +2686,7 @@ int main() {
 
       ut::expect(str == "200"sv);
     }
+#ifndef HARMONY_NO_EXCEPTIONS
     // 例外を投げる
     {
       auto str = std::async([]() -> int {
@@ -1012,7 +2729,183 @@ int main() {
 
       ut::expect(str == "std::future_error"sv);
     }
+#endif
+  };
+
+  "defer test"_test = [] {
+    using namespace harmony::monadic_op;
+    using namespace std::string_view_literals;
+
+    // executorは省略できない
+    static_assert(not std::invocable<decltype(harmony::defer), std::future<int>>);
+    static_assert(std::invocable<decltype(harmony::defer), std::future<int>, harmony::inline_executor>);
+    {
+      std::promise<int> p;
+      harmony::thread_pool pool{1};
+
+      // executorを指定すれば、値の準備ができていなくてもブロックしない
+      std::future<std::string> result = harmony::defer(p.get_future(), pool)
+        | map([](int n) { return n * 2; })
+        | and_then([](int n) { return harmony::sachet<std::exception_ptr, std::string>(std::in_place_index<1>, std::to_string(n)); })
+        | map_err([](std::exception_ptr) { return std::string{"error"}; })
+        | fold_to<std::string>
+        | to_future;
+
+      p.set_value(21);
+
+      ut::expect(result.get() == "42"sv);
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      std::promise<int> p;
+
+      auto result = harmony::defer(p.get_future(), harmony::new_thread_executor{})
+        | [](int n) { return n + 1; }
+        | map([](int n) { return std::to_string(n); })
+        | to_future;
+
+      p.set_exception(std::make_exception_ptr(std::runtime_error("error!!")));
+
+      auto r = result.get();
+      ut::expect(not harmony::validate(r));
+
+      try {
+        std::rethrow_exception(harmony::unwrap_other(r));
+      } catch (const std::runtime_error& ex) {
+        ut::expect(ex.what() == "error!!"sv);
+      }
+    }
+#endif
+    {
+      // 結果はfuture-likeなので、そのまま通常のチェーンに繋げられる
+      harmony::inline_executor exec;
+
+      auto str = harmony::defer(std::async([] { return 10; }), exec)
+        | [](int n) { return n * 10; }
+        | map_to<int>
+        | to_future
+        | then([](int n) { return n + 1; })
+        | map([](int n) { return std::to_string(n); })
+        | map_err([](std::exception_ptr) { return std::string{"error"}; })
+        | fold_to<std::string>;
+
+      ut::expect(str == "101"sv);
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      // 継続内の例外はstd::futureに格納される
+      auto result = harmony::defer(std::async([] { return 10; }), harmony::inline_executor{})
+        | map([](int) -> int { throw std::logic_error("throw in continuation"); })
+        | to_future;
+
+      bool thrown = false;
+      try {
+        result.get();
+      } catch (const std::logic_error&) {
+        thrown = true;
+      }
+
+      ut::expect(thrown);
+    }
+#endif
+  };
+
+#ifdef __cpp_lib_coroutine
+  "coroutine test"_test = [] {
+    {
+      auto add = [](std::optional<int> a, std::optional<int> b) -> harmony::maybe_task<int> {
+        int x = co_await a;
+        int y = co_await b;
+        co_return x + y;
+      };
+
+      ut::expect(add(1, 2) == 3);
+      ut::expect(add(1, std::nullopt) == std::nullopt);
+      ut::expect(add(std::nullopt, 2) == std::nullopt);
+
+      // std::optionalとして受け取れる
+      std::optional<int> r = add(2, 3);
+      ut::expect(r == 5);
+      ut::expect(harmony::maybe<harmony::maybe_task<int>>);
+    }
+    {
+      using result_t = harmony::sachet<std::string, int>;
+      int count = 0;
+
+      auto parse = [](int n) -> tl::expected<int, std::string> {
+        if (n < 0) return tl::unexpected<std::string>("negative");
+        return n * 10;
+      };
+
+      auto f = [&](int a, int b) -> result_t {
+        int x = co_await parse(a);
+        ++count;
+        int y = co_await parse(b);
+        ++count;
+        co_return x + y;
+      };
+
+      auto r1 = f(1, 2);
+      ut::expect(bool(r1));
+      ut::expect(30_i == *r1);
+      ut::expect(2_i == count);
+
+      // 無効値の場合は以降の処理を実行せず、unwrap_other()の値を返す
+      auto r2 = f(1, -1);
+      ut::expect(not bool(r2));
+      ut::expect(r2.unwrap_err() == "negative");
+      ut::expect(3_i == count);
+
+      auto r3 = f(-1, 2);
+      ut::expect(not bool(r3));
+      ut::expect(3_i == count);
+    }
+    {
+      using result_t = harmony::sachet<std::string, int>;
+
+      // eitherでないmaybeの無効値はデフォルト構築された値になる
+      auto deref = [](int* p) -> result_t {
+        int n = co_await p;
+        co_return n + 1;
+      };
+
+      int n = 10;
+      ut::expect(11_i == *deref(&n));
+      ut::expect(deref(nullptr).unwrap_err().empty());
+
+      // 戻り値型のオブジェクトをそのままco_returnできる
+      auto pass = [](std::optional<int> opt) -> result_t {
+        int v = co_await opt;
+        if (v == 0) co_return result_t(std::in_place_index<0>, "zero");
+        co_return v;
+      };
+
+      ut::expect(pass(0).unwrap_err() == "zero");
+      ut::expect(5_i == *pass(5));
+    }
+#ifndef HARMONY_NO_EXCEPTIONS
+    {
+      auto f = [](std::optional<int> opt) -> harmony::maybe_task<int> {
+        int v = co_await opt;
+        if (v == 0) throw std::logic_error("zero");
+        co_return v;
+      };
+
+      ut::expect(f(1) == 1);
+
+      // 本体から送出された例外は呼び出し元に伝播する
+      bool thrown = false;
+      try {
+        [[maybe_unused]] auto r = f(0);
+      } catch (const std::logic_error&) {
+        thrown = true;
+      }
+
+      ut::expect(thrown);
+    }
+#endif
   };
+#endif // __cpp_lib_coroutine
 
   "value_or"_test = [] {
     {